@@ -0,0 +1,71 @@
+#include "anim_rng.h"
+
+/* Half-normal inverse CDF in Q15: entry k = Φ⁻¹(0.5 + 0.5·k/256).  The
+ * last entry replaces +∞ with the value that makes the piecewise-linear
+ * distribution's variance exactly 1 (3.444σ).  Generated offline, so no
+ * libm results enter the sampler. */
+static const int32_t s_half_normal_q15[257] = {
+         0,    160,    321,    481,    642,    802,    963,   1123,
+      1284,   1444,   1605,   1766,   1926,   2087,   2248,   2409,
+      2569,   2730,   2891,   3052,   3214,   3375,   3536,   3698,
+      3859,   4021,   4182,   4344,   4506,   4668,   4830,   4992,
+      5155,   5317,   5480,   5643,   5806,   5969,   6132,   6295,
+      6459,   6622,   6786,   6950,   7114,   7279,   7443,   7608,
+      7773,   7938,   8103,   8269,   8434,   8600,   8766,   8933,
+      9099,   9266,   9433,   9601,   9768,   9936,  10104,  10273,
+     10441,  10610,  10779,  10949,  11119,  11289,  11459,  11630,
+     11801,  11972,  12144,  12316,  12488,  12661,  12834,  13007,
+     13181,  13355,  13530,  13704,  13880,  14055,  14232,  14408,
+     14585,  14762,  14940,  15118,  15297,  15476,  15656,  15836,
+     16016,  16197,  16379,  16561,  16743,  16926,  17110,  17294,
+     17479,  17664,  17850,  18036,  18223,  18411,  18599,  18788,
+     18977,  19167,  19358,  19549,  19741,  19934,  20127,  20321,
+     20516,  20712,  20908,  21105,  21303,  21501,  21701,  21901,
+     22102,  22303,  22506,  22710,  22914,  23119,  23326,  23533,
+     23741,  23950,  24160,  24371,  24583,  24796,  25010,  25225,
+     25442,  25659,  25878,  26097,  26318,  26540,  26764,  26988,
+     27214,  27441,  27670,  27900,  28131,  28363,  28597,  28833,
+     29070,  29309,  29549,  29790,  30034,  30279,  30525,  30774,
+     31024,  31276,  31530,  31786,  32044,  32304,  32565,  32829,
+     33095,  33364,  33634,  33907,  34182,  34460,  34740,  35023,
+     35308,  35596,  35887,  36181,  36477,  36777,  37080,  37385,
+     37695,  38007,  38323,  38643,  38967,  39294,  39625,  39960,
+     40300,  40644,  40992,  41346,  41704,  42067,  42435,  42809,
+     43189,  43574,  43965,  44363,  44768,  45179,  45598,  46024,
+     46458,  46901,  47352,  47813,  48283,  48763,  49254,  49756,
+     50270,  50797,  51337,  51892,  52462,  53048,  53652,  54274,
+     54917,  55582,  56270,  56984,  57726,  58499,  59307,  60151,
+     61038,  61972,  62959,  64007,  65124,  66323,  67618,  69028,
+     70578,  72305,  74260,  76521,  79219,  82592,  87165,  94556,
+    112852,
+};
+
+static inline uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void anim_rng_seed(anim_rng_t *rng, uint64_t seed)
+{
+    uint64_t a = splitmix64(&seed);
+    uint64_t b = splitmix64(&seed);
+    rng->s[0] = (uint32_t)a;
+    rng->s[1] = (uint32_t)(a >> 32);
+    rng->s[2] = (uint32_t)b;
+    rng->s[3] = (uint32_t)(b >> 32);
+}
+
+int32_t anim_rng_normal_q15(anim_rng_t *rng)
+{
+    /* bit 31: sign, bits 30–23: segment, bits 22–8: position within it */
+    uint32_t u    = anim_rng_u32(rng);
+    uint32_t seg  = (u >> 23) & 0xFF;
+    int32_t  frac = (int32_t)((u >> 8) & 0x7FFF);
+    int32_t  a    = s_half_normal_q15[seg];
+    int32_t  b    = s_half_normal_q15[seg + 1];
+    int32_t  z    = a + (int32_t)(((int64_t)(b - a) * frac) >> 15);
+    return (u & 0x80000000u) ? -z : z;
+}
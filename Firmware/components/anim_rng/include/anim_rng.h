@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Animation RNG — seedable software generator for effect noise.
+ *
+ * xoshiro128** (32-bit state words, no multiplies wider than 32 bits) with
+ * a table-based normal sampler.  Everything is integer arithmetic except
+ * the final Q15 → float conversion, so a given seed produces the same
+ * sequence bit for bit on the device and on a host build.  Not for
+ * anything security related — use esp_random() for that (and to pick a
+ * seed).
+ *
+ * A generator is plain state owned by one task; there is no locking.
+ */
+
+typedef struct {
+    uint32_t s[4];
+} anim_rng_t;
+
+/**
+ * Seed a generator.  Any 64-bit value is valid, including 0 (the seed is
+ * expanded with splitmix64, so the state is never all-zero).
+ */
+void anim_rng_seed(anim_rng_t *rng, uint64_t seed);
+
+/**
+ * Next 32 uniformly distributed bits.
+ */
+static inline uint32_t anim_rng_u32(anim_rng_t *rng)
+{
+    uint32_t *s = rng->s;
+    uint32_t x = s[1] * 5;
+    uint32_t result = ((x << 7) | (x >> 25)) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 11) | (s[3] >> 21);
+    return result;
+}
+
+/**
+ * Uniform float in [0, 1) with 24 bits of resolution.
+ */
+static inline float anim_rng_uniform(anim_rng_t *rng)
+{
+    return (float)(anim_rng_u32(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * Standard normal sample in Q15 (32768 = 1σ).  One generator call per
+ * sample; the tails are cut at ±3.44σ with the variance kept at exactly 1.
+ */
+int32_t anim_rng_normal_q15(anim_rng_t *rng);
+
+/**
+ * Standard normal sample as float (same sequence as anim_rng_normal_q15).
+ */
+static inline float anim_rng_normal(anim_rng_t *rng)
+{
+    return (float)anim_rng_normal_q15(rng) * (1.0f / 32768.0f);
+}
+
+#ifdef __cplusplus
+}
+#endif
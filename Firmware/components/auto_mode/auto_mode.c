@@ -1,9 +1,14 @@
 #include "auto_mode.h"
 #include "led_driver.h"
+#include "lamp_fade.h"
 #include "lamp_nvs.h"
-#include "esp_timer.h"
+#include "lamp_timer.h"
 #include "esp_log.h"
-#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+/* Sync abort of a fade-out: back to full over this long */
+#define AUTO_RESUME_MS  500
 
 static const char *TAG = "auto_mode";
 
@@ -16,18 +21,19 @@ static uint8_t         s_current_lux = 100;    /* assume bright until first read
 static uint8_t s_fade_in_s  = FADE_IN_S_DEFAULT;
 static uint8_t s_fade_out_s = FADE_OUT_S_DEFAULT;
 
-/* Fade state */
-static uint8_t  s_fade_current_master = 0;
-static uint8_t  s_fade_start_master   = 0;
-static uint8_t  s_fade_target_master  = 0;
-static int64_t  s_fade_start_us       = 0;
-static uint32_t s_fade_duration_us    = 0;
+/* Fades move the compositor's envelope layer (0–255, on top of the scene
+ * master) through the fade engine; the level showing is lamp_get_fade() */
 
-static esp_timer_handle_t s_timeout_timer;   /* one-shot inactivity timer */
-static esp_timer_handle_t s_fade_timer;      /* periodic 50 ms fade tick  */
-static esp_timer_handle_t s_suppress_timer;  /* touch-off suppress timer  */
+static lamp_timer_t       s_timeout_timer;   /* one-shot inactivity timer */
+static lamp_timer_t       s_suppress_timer;  /* touch-off suppress timer  */
 static bool               s_suppressed = false;
-static QueueHandle_t      s_suppress_queue;  /* sensor queue for unsuppress event */
+static QueueHandle_t      s_event_queue;     /* control task: unsuppress, fade done */
+
+/* Envelope fades carry s_fade_seq as their done argument; a new fade,
+ * reversal or cancel moves it on, so a completion that landed (on the
+ * render task) before that is dropped by the control task */
+static uint32_t           s_fade_seq = 1;
+static _Atomic uint32_t   s_fade_done_seq;   /* landed, not yet handled; 0 = none */
 
 /* Saved scene to restore when entering ON state */
 static scene_t s_active_scene;
@@ -47,7 +53,7 @@ void auto_mode_set_fade_rates(uint8_t fade_in_s, uint8_t fade_out_s)
 }
 
 /* ── Forward declarations ── */
-static void start_fade_in(bool prep_buffer);
+static void start_fade_in(bool prep_buffer, uint32_t duration_ms);
 static void start_fade_out(void);
 
 /* ── Suppress timer callback ── */
@@ -57,7 +63,7 @@ static void suppress_cb(void *arg)
     ESP_LOGI(TAG, "Suppress timer expired → posting unsuppress event");
     s_suppressed = false;
     sensor_event_t evt = { .type = SENSOR_EVT_AUTO_UNSUPPRESS };
-    xQueueSend(s_suppress_queue, &evt, 0);
+    xQueueSend(s_event_queue, &evt, 0);
 }
 
 /* ── Inactivity timeout callback ── */
@@ -70,89 +76,93 @@ static void timeout_cb(void *arg)
     }
 }
 
-/* ── Periodic fade tick ── */
+/* ── Fade completion ── */
 
-static void fade_timer_cb(void *arg)
+/* Runs on the LED render task: hand the completion to the control task.
+ * A full queue loses only the wake-up — the next event runs it. */
+static void fade_landed(void *arg)
 {
-    int64_t elapsed = esp_timer_get_time() - s_fade_start_us;
-    float progress = (s_fade_duration_us > 0)
-                     ? (float)elapsed / (float)s_fade_duration_us
-                     : 1.0f;
-    if (progress > 1.0f) progress = 1.0f;
-
-    float master_f = s_fade_start_master
-                     + (s_fade_target_master - s_fade_start_master) * progress;
-    uint8_t m = (uint8_t)(master_f + 0.5f);
-    s_fade_current_master = m;
-
-    if (s_transition_cb) {
-        s_transition_cb(AUTO_TRANSITION_DIMMING, m);
-    }
+    atomic_store(&s_fade_done_seq, (uint32_t)(uintptr_t)arg);
+    sensor_event_t evt = { .type = SENSOR_EVT_FADE_DONE };
+    xQueueSend(s_event_queue, &evt, 0);
+}
 
-    if (progress >= 1.0f) {
-        esp_timer_stop(s_fade_timer);
+/* Stop the auto fade where it is and drop a completion still queued */
+static void fade_cancel(void)
+{
+    lamp_fade_stop(fade_landed, (void *)(uintptr_t)s_fade_seq);
+    s_fade_seq++;
+}
 
-        if (s_state == AUTO_STATE_FADING_OUT) {
-            ESP_LOGI(TAG, "Fade out complete → IDLE");
-            s_state = AUTO_STATE_IDLE;
-            if (s_transition_cb) {
-                s_transition_cb(AUTO_TRANSITION_OFF, 0);
-            }
-        } else if (s_state == AUTO_STATE_FADING_IN) {
-            ESP_LOGI(TAG, "Fade in complete → ON");
-            s_state = AUTO_STATE_ON;
-            /* Notify lamp_control that we're fully on (s_lamp_on tracking) */
-            if (s_transition_cb) {
-                s_transition_cb(AUTO_TRANSITION_ON, s_active_scene.master);
-            }
-            /* Start inactivity timer */
-            esp_timer_start_once(s_timeout_timer,
-                                 (uint64_t)s_cfg.timeout_s * 1000000);
+void auto_mode_fade_done(void)
+{
+    uint32_t seq = atomic_exchange(&s_fade_done_seq, 0);
+    if (seq != s_fade_seq) return;
+
+    if (s_state == AUTO_STATE_FADING_OUT) {
+        ESP_LOGI(TAG, "Fade out complete → IDLE");
+        s_state = AUTO_STATE_IDLE;
+        if (s_transition_cb) {
+            s_transition_cb(AUTO_TRANSITION_OFF, 0);
         }
+    } else if (s_state == AUTO_STATE_FADING_IN) {
+        ESP_LOGI(TAG, "Fade in complete → ON");
+        s_state = AUTO_STATE_ON;
+        /* Notify lamp_control that we're fully on (s_lamp_on tracking) */
+        if (s_transition_cb) {
+            s_transition_cb(AUTO_TRANSITION_ON, AUTO_FADE_FULL);
+        }
+        /* Start inactivity timer */
+        lamp_timer_start_once(&s_timeout_timer,
+                              (uint64_t)s_cfg.timeout_s * 1000000);
     }
 }
 
+/* Envelope fade to @p level; eased at both ends so neither the start nor
+ * the landing is abrupt */
+static void fade_envelope(uint8_t level, uint32_t duration_ms)
+{
+    const lamp_fade_level_t to = { .envelope = level };
+    s_fade_seq++;
+    lamp_fade_to(&to, LAMP_FADE_ENVELOPE, duration_ms, LAMP_EASE_IN_OUT,
+                 fade_landed, (void *)(uintptr_t)s_fade_seq);
+}
+
 /* ── Fade helpers ── */
 
-static void start_fade_in(bool prep_buffer)
+static void start_fade_in(bool prep_buffer, uint32_t duration_ms)
 {
-    uint8_t target = s_active_scene.master;
-
-    if (s_fade_in_s == 0) {
+    if (duration_ms == 0) {
         /* Instant ON */
-        s_fade_current_master = target;
+        fade_cancel();
         s_state = AUTO_STATE_ON;
         if (s_transition_cb) {
-            s_transition_cb(AUTO_TRANSITION_ON, target);
+            s_transition_cb(AUTO_TRANSITION_ON, AUTO_FADE_FULL);
         }
-        esp_timer_start_once(s_timeout_timer,
-                             (uint64_t)s_cfg.timeout_s * 1000000);
-        ESP_LOGI(TAG, "Instant ON (master=%u)", target);
+        lamp_timer_start_once(&s_timeout_timer,
+                              (uint64_t)s_cfg.timeout_s * 1000000);
+        ESP_LOGI(TAG, "Instant ON (master=%u)", s_active_scene.master);
         return;
     }
 
-    /* Prepare the LED buffer with scene colors at the current brightness */
+    /* Prepare the LED buffer with scene colors, dark (envelope 0) */
     if (prep_buffer && s_transition_cb) {
-        s_transition_cb(AUTO_TRANSITION_ON, s_fade_current_master);
+        s_transition_cb(AUTO_TRANSITION_ON, 0);
     }
 
-    s_fade_start_master  = s_fade_current_master;
-    s_fade_target_master = target;
-    s_fade_duration_us   = (uint32_t)s_fade_in_s * 1000000UL;
-    s_fade_start_us      = esp_timer_get_time();
-    s_state              = AUTO_STATE_FADING_IN;
-
-    esp_timer_start_periodic(s_fade_timer, 50000);  /* 50 ms */
-    ESP_LOGI(TAG, "Fade in: %u→%u over %us", s_fade_start_master, target, s_fade_in_s);
+    uint8_t from = lamp_get_fade();
+    s_state = AUTO_STATE_FADING_IN;
+    fade_envelope(AUTO_FADE_FULL, duration_ms);
+    ESP_LOGI(TAG, "Fade in: %u→%u over %lums", from, AUTO_FADE_FULL, (unsigned long)duration_ms);
 }
 
 static void start_fade_out(void)
 {
-    uint8_t from = s_active_scene.master;
+    uint8_t from = lamp_get_fade();
 
     if (s_fade_out_s == 0) {
         /* Instant OFF */
-        s_fade_current_master = 0;
+        fade_cancel();
         s_state = AUTO_STATE_IDLE;
         if (s_transition_cb) {
             s_transition_cb(AUTO_TRANSITION_OFF, 0);
@@ -161,46 +171,25 @@ static void start_fade_out(void)
         return;
     }
 
-    s_fade_start_master  = from;
-    s_fade_current_master = from;
-    s_fade_target_master = 0;
-    s_fade_duration_us   = (uint32_t)s_fade_out_s * 1000000UL;
-    s_fade_start_us      = esp_timer_get_time();
-    s_state              = AUTO_STATE_FADING_OUT;
-
-    esp_timer_start_periodic(s_fade_timer, 50000);  /* 50 ms */
+    s_state = AUTO_STATE_FADING_OUT;
+    fade_envelope(0, (uint32_t)s_fade_out_s * 1000);
     ESP_LOGI(TAG, "Fade out: %u→0 over %us", from, s_fade_out_s);
 }
 
 /* ── Public API ── */
 
-esp_err_t auto_mode_init(void)
+esp_err_t auto_mode_init(QueueHandle_t event_queue)
 {
+    s_event_queue = event_queue;
+
     /* s_cfg populated via auto_mode_set_config() called from lamp_control_init */
     s_cfg.timeout_s     = AUTO_TIMEOUT_S_DEFAULT;
     s_cfg.lux_threshold = AUTO_LUX_DEFAULT;
     s_cfg.suppress_min  = AUTO_SUPPRESS_MIN_DEFAULT;
     lamp_nvs_load_active_scene(&s_active_scene);
 
-    esp_timer_create_args_t timeout_args = {
-        .callback = timeout_cb,
-        .name     = "auto_timeout",
-    };
-    esp_timer_create(&timeout_args, &s_timeout_timer);
-
-    esp_timer_create_args_t fade_args = {
-        .callback          = fade_timer_cb,
-        .dispatch_method   = ESP_TIMER_TASK,
-        .name              = "auto_fade",
-        .skip_unhandled_events = true,
-    };
-    esp_timer_create(&fade_args, &s_fade_timer);
-
-    esp_timer_create_args_t suppress_args = {
-        .callback = suppress_cb,
-        .name     = "auto_suppress",
-    };
-    esp_timer_create(&suppress_args, &s_suppress_timer);
+    lamp_timer_init(&s_timeout_timer, "auto_timeout", timeout_cb, NULL);
+    lamp_timer_init(&s_suppress_timer, "auto_suppress", suppress_cb, NULL);
 
     ESP_LOGI(TAG, "Auto mode initialised (timeout=%us, lux_thresh=%u, suppress=%umin)",
              s_cfg.timeout_s, s_cfg.lux_threshold, s_cfg.suppress_min);
@@ -212,17 +201,15 @@ void auto_mode_enable(void)
     auto_mode_cancel_suppress();
     s_enabled = true;
     s_state = AUTO_STATE_IDLE;
-    s_fade_current_master = 0;
     ESP_LOGI(TAG, "Auto mode enabled");
 }
 
 void auto_mode_disable(void)
 {
     s_enabled = false;
-    esp_timer_stop(s_timeout_timer);
-    esp_timer_stop(s_fade_timer);
+    lamp_timer_stop(&s_timeout_timer);
+    fade_cancel();
     s_state = AUTO_STATE_IDLE;
-    s_fade_current_master = 0;
     ESP_LOGI(TAG, "Auto mode disabled");
 }
 
@@ -242,21 +229,18 @@ void auto_mode_process_event(const sensor_event_t *evt)
                 ESP_LOGI(TAG, "Motion + dark (lux=%u) → fade in", s_current_lux);
                 /* s_active_scene is always current via auto_mode_notify_scene_change() —
                  * no NVS load needed here. */
-                s_fade_current_master = 0;
-                start_fade_in(true);
+                start_fade_in(true, (uint32_t)s_fade_in_s * 1000);
             }
         } else if (s_state == AUTO_STATE_FADING_OUT) {
             /* Reverse: stop fade-out, fade back in from current brightness */
-            ESP_LOGI(TAG, "Motion during fade-out → reverse to fade in (from master=%u)",
-                     s_fade_current_master);
-            esp_timer_stop(s_fade_timer);
-            start_fade_in(false);
+            ESP_LOGI(TAG, "Motion during fade-out → reverse to fade in (from level=%u)",
+                     lamp_get_fade());
+            start_fade_in(false, (uint32_t)s_fade_in_s * 1000);
         } else if (s_state == AUTO_STATE_ON || s_state == AUTO_STATE_FADING_IN) {
             /* Motion while on or fading in — restart inactivity timeout */
             if (s_state == AUTO_STATE_ON) {
-                esp_timer_stop(s_timeout_timer);
-                esp_timer_start_once(s_timeout_timer,
-                                     (uint64_t)s_cfg.timeout_s * 1000000);
+                lamp_timer_start_once(&s_timeout_timer,
+                                      (uint64_t)s_cfg.timeout_s * 1000000);
             }
         }
         break;
@@ -289,8 +273,7 @@ void auto_mode_get_config(auto_config_t *cfg)
 void auto_mode_force_on(void)
 {
     if (!s_enabled || s_state != AUTO_STATE_IDLE) return;
-    s_fade_current_master = 0;
-    start_fade_in(true);
+    start_fade_in(true, (uint32_t)s_fade_in_s * 1000);
     ESP_LOGI(TAG, "Force ON (group sync)");
 }
 
@@ -298,13 +281,19 @@ void auto_mode_force_off(void)
 {
     if (!s_enabled) return;
     if (s_state == AUTO_STATE_ON || s_state == AUTO_STATE_FADING_IN) {
-        esp_timer_stop(s_timeout_timer);
-        esp_timer_stop(s_fade_timer);
+        lamp_timer_stop(&s_timeout_timer);
         start_fade_out();
         ESP_LOGI(TAG, "Force OFF (group sync)");
     }
 }
 
+void auto_mode_cancel(void)
+{
+    lamp_timer_stop(&s_timeout_timer);
+    fade_cancel();
+    s_state = AUTO_STATE_IDLE;
+}
+
 void auto_mode_notify_scene_change(uint8_t warm, uint8_t neutral,
                                    uint8_t cool, uint8_t master)
 {
@@ -313,23 +302,15 @@ void auto_mode_notify_scene_change(uint8_t warm, uint8_t neutral,
     s_active_scene.cool    = cool;
     s_active_scene.master  = master;
 
+    /* The envelope is relative to the scene master, so an in-progress fade-in
+     * needs no retargeting — the compositor picks up the new master. */
     switch (s_state) {
-    case AUTO_STATE_FADING_IN:
-        /* Redirect the in-progress fade to the new master target */
-        s_fade_target_master = master;
-        break;
-
     case AUTO_STATE_FADING_OUT:
         if (master > 0) {
-            /* Sync says stay on — abort fade-out and return to ON state */
-            esp_timer_stop(s_fade_timer);
-            s_state = AUTO_STATE_ON;
-            s_fade_current_master = master;
-            /* Restart inactivity timer from now */
-            esp_timer_stop(s_timeout_timer);
-            esp_timer_start_once(s_timeout_timer,
-                                 (uint64_t)s_cfg.timeout_s * 1000000);
+            /* Sync says stay on — abort fade-out and come back up quickly;
+             * the inactivity timer restarts once fully on */
             ESP_LOGI(TAG, "Sync override: abort fade-out → ON (master=%u)", master);
+            start_fade_in(false, AUTO_RESUME_MS);
         }
         break;
 
@@ -343,17 +324,16 @@ void auto_mode_suppress(uint16_t minutes, QueueHandle_t event_queue)
 {
     auto_mode_disable();
     s_suppressed = true;
-    s_suppress_queue = event_queue;
-    esp_timer_stop(s_suppress_timer);
+    s_event_queue = event_queue;
     uint64_t us = (uint64_t)minutes * 60ULL * 1000000ULL;
-    esp_timer_start_once(s_suppress_timer, us);
+    lamp_timer_start_once(&s_suppress_timer, us);
     ESP_LOGI(TAG, "Auto mode suppressed for %u minutes", minutes);
 }
 
 void auto_mode_cancel_suppress(void)
 {
     if (s_suppressed) {
-        esp_timer_stop(s_suppress_timer);
+        lamp_timer_stop(&s_suppress_timer);
         s_suppressed = false;
         ESP_LOGI(TAG, "Suppress cancelled");
     }
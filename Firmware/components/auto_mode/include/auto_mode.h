@@ -16,22 +16,26 @@ typedef enum {
     AUTO_STATE_FADING_OUT,
 } auto_state_t;
 
+/* Fade envelope at full brightness (the scene master is applied separately) */
+#define AUTO_FADE_FULL  255
+
 /**
  * Auto mode transition types, used in the transition callback.
  */
 typedef enum {
-    AUTO_TRANSITION_ON,       /* fade-in starting (dim_master = initial brightness) or instant ON */
-    AUTO_TRANSITION_DIMMING,  /* smooth fade tick — set LED master to dim_master */
+    AUTO_TRANSITION_ON,       /* fade-in starting (level = initial envelope) or fully ON */
     AUTO_TRANSITION_OFF,      /* fade-out complete; turn off LEDs */
 } auto_transition_t;
 
 /**
  * Callback invoked on auto mode state transitions.
  * @param transition  The transition type.
- * @param dim_master  Brightness value: initial master for ON, current for DIMMING, ignored for OFF.
+ * @param level       Fade envelope (0–255, AUTO_FADE_FULL = scene master):
+ *                    initial level for ON, ignored for OFF.  The fade itself
+ *                    runs on the fade engine (lamp_fade.h) between the two.
  */
 typedef void (*auto_mode_transition_cb_t)(auto_transition_t transition,
-                                          uint8_t dim_master);
+                                          uint8_t level);
 
 /**
  * Set the transition callback (call before auto_mode_enable).
@@ -39,9 +43,18 @@ typedef void (*auto_mode_transition_cb_t)(auto_transition_t transition,
 void auto_mode_set_transition_cb(auto_mode_transition_cb_t cb);
 
 /**
- * Initialise the auto-mode module (loads config from NVS).
+ * Initialise the auto-mode module (loads config from NVS).  Fade
+ * completions are signalled with a SENSOR_EVT_FADE_DONE on @p event_queue.
+ */
+esp_err_t auto_mode_init(QueueHandle_t event_queue);
+
+/**
+ * Finish a fade that has landed: moves to ON or IDLE and calls the
+ * transition callback.  Call from the control task on every loop pass (at
+ * least after each SENSOR_EVT_FADE_DONE); a fade reversed or cancelled
+ * since it landed is ignored.
  */
-esp_err_t auto_mode_init(void);
+void auto_mode_fade_done(void);
 
 /**
  * Enable auto mode — the state machine begins processing sensor events.
@@ -103,6 +116,13 @@ void auto_mode_force_on(void);
  */
 void auto_mode_force_off(void);
 
+/**
+ * Drop back to IDLE without a transition callback: stops the inactivity
+ * timer and any auto fade.  For when lamp_control takes the LEDs over
+ * itself (e.g. an explicit off from the app).  Stays enabled.
+ */
+void auto_mode_cancel(void);
+
 /**
  * Temporarily suppress auto mode for @p minutes.
  * Disables auto mode and starts a one-shot timer.  When the timer fires,
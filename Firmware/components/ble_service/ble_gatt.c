@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <string.h>
 #include "ble_gatt.h"
 #include "ble_service.h"
@@ -15,6 +16,8 @@
 #include "flame_mode.h"
 #include "esp_now_sync.h"
 #include "circadian_mode.h"
+#include "lamp_timer.h"
+#include "lamp_pm.h"
 
 static const char *TAG = "ble_gatt";
 
@@ -35,6 +38,7 @@ uint16_t g_device_info_handle;
 uint16_t g_sync_config_handle;
 uint16_t g_lamp_name_handle;
 uint16_t g_time_sync_handle;
+uint16_t g_frame_diag_handle;
 
 /* Firmware version string */
 #define FW_VERSION "1.0.0"
@@ -69,22 +73,28 @@ static int led_state_access(uint16_t conn_handle, uint16_t attr_handle,
     return BLE_ATT_ERR_UNLIKELY;
 }
 
-/* ── Mode Flags (0002): R/W — [flags: u8 bitmask] ── */
+/* ── Mode Flags (0002): R/W — [flags: u8 bitmask, effect_id: u8 (optional on write)] ── */
 
 static int mode_access(uint16_t conn_handle, uint16_t attr_handle,
                        struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
     if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR) {
-        uint8_t flags = lamp_control_get_flags();
-        os_mbuf_append(ctxt->om, &flags, 1);
+        uint8_t buf[2] = { lamp_control_get_flags(), lamp_control_get_effect() };
+        os_mbuf_append(ctxt->om, buf, sizeof(buf));
         return 0;
     }
 
     if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
-        uint8_t flags;
-        os_mbuf_copydata(ctxt->om, 0, 1, &flags);
-        if (flags & ~MODE_FLAGS_MASK) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
-        lamp_control_set_flags(flags);
+        uint16_t len = OS_MBUF_PKTLEN(ctxt->om);
+        if (len < 1) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        uint8_t buf[2];
+        os_mbuf_copydata(ctxt->om, 0, len >= 2 ? 2 : 1, buf);
+        if (buf[0] & ~MODE_FLAGS_MASK) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        /* Effect first, so a combined write starts the requested effect */
+        if (len >= 2 && lamp_control_set_effect(buf[1]) != ESP_OK) {
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+        lamp_control_set_flags(buf[0]);
         return 0;
     }
     return BLE_ATT_ERR_UNLIKELY;
@@ -192,6 +202,8 @@ static int scene_write_access(uint16_t conn_handle, uint16_t attr_handle,
     } else {
         scene.auto_suppress_min = AUTO_SUPPRESS_MIN_DEFAULT;
     }
+    scene.flame_style         = SCENE_OPT(17) ? buf[base + 17] : FLAME_STYLE_DEFAULT;
+    scene.effect_id           = SCENE_OPT(18) ? buf[base + 18] : EFFECT_ID_DEFAULT;
 #undef SCENE_OPT
 
     lamp_nvs_save_scene(index, &scene);
@@ -242,6 +254,8 @@ static int scene_list_access(uint16_t conn_handle, uint16_t attr_handle,
         uint8_t suppress_buf[2];
         memcpy(suppress_buf, &scene.auto_suppress_min, 2);
         os_mbuf_append(ctxt->om, suppress_buf, 2);
+        os_mbuf_append(ctxt->om, &scene.flame_style, 1);
+        os_mbuf_append(ctxt->om, &scene.effect_id, 1);
     }
     return 0;
 }
@@ -401,11 +415,13 @@ static int flame_config_access(uint16_t conn_handle, uint16_t attr_handle,
     }
 
     if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        /* 7 bytes = parameters only (style unchanged), 8 = + style */
         uint16_t len = OS_MBUF_PKTLEN(ctxt->om);
-        if (len < sizeof(flame_config_t)) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        if (len < offsetof(flame_config_t, style)) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
 
         flame_config_t cfg;
-        os_mbuf_copydata(ctxt->om, 0, sizeof(cfg), &cfg);
+        flame_mode_get_config(&cfg);
+        os_mbuf_copydata(ctxt->om, 0, len < sizeof(cfg) ? len : sizeof(cfg), &cfg);
         lamp_control_update_flame_config(&cfg);
         return 0;
     }
@@ -488,6 +504,79 @@ static int time_sync_access(uint16_t conn_handle, uint16_t attr_handle,
     return BLE_ATT_ERR_UNLIKELY;
 }
 
+/* ── Frame Diagnostics (0011): R/W ──
+ * Read:  [version:u8=1, bins:u8, frames, dropped, skipped, tx_errors,
+ *         missed_ticks (u32 LE each), then 4 histograms (pack, lock_wait, tx,
+ *         jitter) of bins × u32 LE counts + max_us:u32 LE]
+ * Write: [cmd:u8] — 0x01 = dump to log (with lamp_timer and sleep stats),
+ *        0x02 = reset histograms */
+
+#define FRAME_DIAG_VERSION      1
+#define FRAME_DIAG_CMD_LOG      0x01
+#define FRAME_DIAG_CMD_RESET    0x02
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return p + 4;
+}
+
+static uint8_t *put_hist(uint8_t *p, const led_hist_t *h)
+{
+    for (int i = 0; i < LED_HIST_BINS; i++) p = put_u32(p, h->bins[i]);
+    return put_u32(p, h->max_us);
+}
+
+static int frame_diag_access(uint16_t conn_handle, uint16_t attr_handle,
+                             struct ble_gatt_access_ctxt *ctxt, void *arg)
+{
+    if (ctxt->op == BLE_GATT_ACCESS_OP_READ_CHR) {
+        led_driver_stats_t st;
+        led_timing_t tm;
+        led_driver_get_stats(&st);
+        led_driver_get_timing(&tm);
+
+        uint8_t buf[2 + 5 * 4 + 4 * (LED_HIST_BINS + 1) * 4];
+        uint8_t *p = buf;
+        *p++ = FRAME_DIAG_VERSION;
+        *p++ = LED_HIST_BINS;
+        p = put_u32(p, st.frames);
+        p = put_u32(p, st.dropped);
+        p = put_u32(p, st.skipped);
+        p = put_u32(p, st.tx_errors);
+        p = put_u32(p, tm.missed_ticks);
+        p = put_hist(p, &tm.pack);
+        p = put_hist(p, &tm.lock_wait);
+        p = put_hist(p, &tm.tx);
+        p = put_hist(p, &tm.jitter);
+        os_mbuf_append(ctxt->om, buf, p - buf);
+        return 0;
+    }
+
+    if (ctxt->op == BLE_GATT_ACCESS_OP_WRITE_CHR) {
+        if (OS_MBUF_PKTLEN(ctxt->om) < 1) return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        uint8_t cmd;
+        os_mbuf_copydata(ctxt->om, 0, 1, &cmd);
+        switch (cmd) {
+        case FRAME_DIAG_CMD_LOG:
+            led_driver_log_timing();
+            lamp_timer_log_stats();
+            lamp_pm_log_stats();
+            return 0;
+        case FRAME_DIAG_CMD_RESET:
+            led_driver_reset_timing();
+            ESP_LOGI(TAG, "Frame timing histograms reset");
+            return 0;
+        default:
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+    }
+    return BLE_ATT_ERR_UNLIKELY;
+}
+
 /* ═══════════════════════ GATT Service Definition ═══════════════════════ */
 
 static const ble_uuid128_t svc_uuid = SVC_UUID_BASE;
@@ -508,6 +597,7 @@ static const ble_uuid128_t chr_device_info_uuid      = CHR_UUID(0xAA, 0x0D);
 static const ble_uuid128_t chr_sync_config_uuid      = CHR_UUID(0xAA, 0x0E);
 static const ble_uuid128_t chr_lamp_name_uuid        = CHR_UUID(0xAA, 0x0F);
 static const ble_uuid128_t chr_time_sync_uuid        = CHR_UUID(0xAA, 0x10);
+static const ble_uuid128_t chr_frame_diag_uuid       = CHR_UUID(0xAA, 0x11);
 
 static const struct ble_gatt_svc_def s_gatt_svcs[] = {
     {
@@ -610,6 +700,12 @@ static const struct ble_gatt_svc_def s_gatt_svcs[] = {
                 .val_handle = &g_time_sync_handle,
                 .flags      = BLE_GATT_CHR_F_WRITE,
             },
+            { /* Frame Diagnostics (0011) */
+                .uuid       = &chr_frame_diag_uuid.u,
+                .access_cb  = frame_diag_access,
+                .val_handle = &g_frame_diag_handle,
+                .flags      = BLE_GATT_CHR_F_READ | BLE_GATT_CHR_F_WRITE,
+            },
             { 0 }, /* terminator */
         },
     },
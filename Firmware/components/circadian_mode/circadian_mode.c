@@ -1,6 +1,6 @@
 #include "circadian_mode.h"
 #include "lamp_nvs.h"
-#include "esp_timer.h"
+#include "lamp_timer.h"
 #include "esp_log.h"
 #include <sys/time.h>
 #include <time.h>
@@ -16,7 +16,7 @@ static const char *TAG = "circadian";
 
 #define CIRCADIAN_PERIOD_US  (60 * 1000000ULL)  /* 60 seconds */
 
-static esp_timer_handle_t s_timer;
+static lamp_timer_t       s_timer;
 static bool               s_active;
 static bool               s_time_valid;     /* true after first BLE time sync */
 
@@ -100,11 +100,7 @@ static void circadian_timer_cb(void *arg)
 
 void circadian_mode_init(void)
 {
-    esp_timer_create_args_t args = {
-        .callback = circadian_timer_cb,
-        .name = "circadian",
-    };
-    esp_timer_create(&args, &s_timer);
+    lamp_timer_init(&s_timer, "circadian", circadian_timer_cb, NULL);
 }
 
 void circadian_mode_enable(void)
@@ -116,14 +112,14 @@ void circadian_mode_enable(void)
     if (s_time_valid) {
         circadian_timer_cb(NULL);
     }
-    esp_timer_start_periodic(s_timer, CIRCADIAN_PERIOD_US);
+    lamp_timer_start_periodic(&s_timer, CIRCADIAN_PERIOD_US);
 }
 
 void circadian_mode_disable(void)
 {
     if (!s_active) return;
     s_active = false;
-    esp_timer_stop(s_timer);
+    lamp_timer_stop(&s_timer);
     ESP_LOGI(TAG, "Circadian mode disabled");
 }
 
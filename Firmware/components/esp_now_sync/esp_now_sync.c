@@ -1,3 +1,4 @@
+#include "sdkconfig.h"
 #include "esp_now_sync.h"
 #include "sensor.h"
 #include "esp_wifi.h"
@@ -17,7 +18,7 @@
 static const char *TAG = "esp_now_sync";
 
 #define SYNC_MAGIC      0x4C    /* 'L' for Lamp */
-#define SYNC_VERSION    0x03    /* v3: + auto_suppress_min */
+#define SYNC_VERSION    0x06    /* v6: + transition_ms */
 #define MSG_STATE_SYNC  0x01
 
 #define SYNC_TASK_STACK 3072
@@ -45,7 +46,10 @@ typedef struct __attribute__((packed)) {
     uint16_t auto_suppress_min;
     /* Operational state — decoupled from scene master */
     uint8_t  lamp_on;           /* 0 = off, 1 = on */
-} sync_msg_t;                   /* 31 bytes */
+    uint8_t  flame_style;       /* FLAME_STYLE_* */
+    uint8_t  effect_id;         /* EFFECT_ID_* */
+    uint16_t transition_ms;     /* crossfade to this state on the peers */
+} sync_msg_t;                   /* 34 bytes */
 
 static uint8_t       s_group_id = 0;
 static uint32_t      s_seq = 0;
@@ -76,8 +80,17 @@ static esp_err_t wifi_init_sta_minimal(void)
     /* Pin to channel 1 so all lamps are on the same channel for ESP-NOW */
     ESP_ERROR_CHECK(esp_wifi_set_channel(1, WIFI_SECOND_CHAN_NONE));
 
+#if CONFIG_LAMP_PM_SYNC_LISTEN_WINDOW
+    /* Modem sleep between ESP-NOW listen windows (set in esp_now_sync_init)
+     * so the chip can light-sleep; the 12-shot retry burst spans ~2 s, so
+     * a sleeping lamp still hears part of it */
+    ESP_ERROR_CHECK(esp_wifi_connectionless_module_set_wake_interval(
+                        CONFIG_LAMP_PM_SYNC_WAKE_INTERVAL_MS));
+    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_MIN_MODEM));
+#else
     /* Disable WiFi power save — keeps radio responsive for ESP-NOW */
     ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
+#endif
 
     /* Max TX power (78 = 19.5 dBm) for best ESP-NOW range */
     ESP_ERROR_CHECK(esp_wifi_set_max_tx_power(78));
@@ -154,6 +167,9 @@ static void esp_now_recv_cb(const esp_now_recv_info_t *info,
                 .auto_suppress_min = msg->auto_suppress_min,
                 .pir_sensitivity  = msg->pir_sensitivity,
                 .lamp_on          = msg->lamp_on,
+                .flame_style      = msg->flame_style,
+                .effect_id        = msg->effect_id,
+                .transition_ms    = msg->transition_ms,
             },
         };
         memcpy(evt.data.sync.flame_config, msg->flame_config, 7);
@@ -221,6 +237,11 @@ esp_err_t esp_now_sync_init(QueueHandle_t sensor_queue)
     ESP_ERROR_CHECK(esp_now_init());
     ESP_ERROR_CHECK(esp_now_register_recv_cb(esp_now_recv_cb));
     ESP_ERROR_CHECK(esp_now_register_send_cb(esp_now_send_cb));
+#if CONFIG_LAMP_PM_SYNC_LISTEN_WINDOW
+    ESP_ERROR_CHECK(esp_now_set_wake_window(CONFIG_LAMP_PM_SYNC_WAKE_WINDOW_MS));
+    ESP_LOGI(TAG, "Listening %d ms every %d ms", CONFIG_LAMP_PM_SYNC_WAKE_WINDOW_MS,
+             CONFIG_LAMP_PM_SYNC_WAKE_INTERVAL_MS);
+#endif
 
     /* Add broadcast peer */
     esp_now_peer_info_t peer = {
@@ -242,7 +263,7 @@ esp_err_t esp_now_sync_init(QueueHandle_t sensor_queue)
     return ESP_OK;
 }
 
-void esp_now_sync_broadcast(const scene_t *scene, bool lamp_on)
+void esp_now_sync_broadcast(const scene_t *scene, bool lamp_on, uint32_t transition_ms)
 {
     if (s_group_id == 0) return;
 
@@ -264,6 +285,9 @@ void esp_now_sync_broadcast(const scene_t *scene, bool lamp_on)
         .auto_suppress_min = scene->auto_suppress_min,
         .pir_sensitivity  = scene->pir_sensitivity,
         .lamp_on          = lamp_on ? 1 : 0,
+        .flame_style      = scene->flame_style,
+        .effect_id        = scene->effect_id,
+        .transition_ms    = transition_ms > UINT16_MAX ? UINT16_MAX : transition_ms,
     };
     msg.flame_config[0] = scene->flame_drift_x;
     msg.flame_config[1] = scene->flame_drift_y;
@@ -28,8 +28,10 @@ esp_err_t esp_now_sync_init(QueueHandle_t sensor_queue);
  * @param lamp_on Whether the lamp is currently on (operational state).
  *                Kept separate from scene->master so master is never
  *                artificially zeroed to signal "off".
+ * @param transition_ms  How long peers take to crossfade to the new state
+ *                (clamped to 65535).
  */
-void esp_now_sync_broadcast(const scene_t *scene, bool lamp_on);
+void esp_now_sync_broadcast(const scene_t *scene, bool lamp_on, uint32_t transition_ms);
 
 /** Get current group ID (0 = disabled). */
 uint8_t esp_now_sync_get_group(void);
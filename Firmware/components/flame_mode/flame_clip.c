@@ -0,0 +1,235 @@
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "flame_clip.h"
+
+static const char *TAG = "flame_clip";
+
+#define CLIP_MAGIC          0x504C4346      /* "FCLP" */
+#define CLIP_VERSION        1
+#define CLIP_STAGE_SIZE     4096            /* flash write staging buffer */
+#define CLIP_FRAME_MAX      (1 + LED_COUNT) /* worst-case coded frame (b = 8) */
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t led_count;
+    uint32_t key;
+    uint32_t frames;
+    uint32_t data_len;      /* coded frame bytes following the header */
+    uint32_t data_crc;      /* CRC-32 of the coded frames */
+    uint32_t reserved[2];
+} clip_header_t;            /* 32 bytes */
+
+/* Playback state — owned by the render task between open and close */
+static esp_partition_mmap_handle_t s_map;
+static const uint8_t *s_data;
+static const uint8_t *s_end;
+static const uint8_t *s_pos;
+static uint8_t        s_level[LED_COUNT];
+
+static const esp_partition_t *clip_partition(void)
+{
+    return esp_partition_find_first(ESP_PARTITION_TYPE_DATA, FLAME_CLIP_PARTITION_TYPE,
+                                    FLAME_CLIP_PARTITION_LABEL);
+}
+
+/* ── Coding ── */
+
+static int encode_frame(const uint8_t *prev, const uint8_t *cur, uint8_t *out)
+{
+    uint8_t zz[LED_COUNT];
+    uint8_t any = 0;
+    for (int i = 0; i < LED_COUNT; i++) {
+        int d = (int8_t)(cur[i] - prev[i]);
+        zz[i] = (uint8_t)(((unsigned)d << 1) ^ (unsigned)(d >> 7));
+        any |= zz[i];
+    }
+
+    int bits = 0;
+    while (any >> bits) bits++;
+
+    int n = 0;
+    out[n++] = (uint8_t)bits;
+    uint32_t acc = 0;
+    int acc_bits = 0;
+    for (int i = 0; i < LED_COUNT && bits; i++) {
+        acc |= (uint32_t)zz[i] << acc_bits;
+        acc_bits += bits;
+        while (acc_bits >= 8) {
+            out[n++] = (uint8_t)acc;
+            acc >>= 8;
+            acc_bits -= 8;
+        }
+    }
+    if (acc_bits) out[n++] = (uint8_t)acc;
+    return n;
+}
+
+static const uint8_t *decode_frame(const uint8_t *p, uint8_t level[LED_COUNT])
+{
+    int bits = *p++;
+    if (!bits) return p;
+
+    uint32_t mask = (1u << bits) - 1;
+    uint32_t acc = 0;
+    int acc_bits = 0;
+    for (int i = 0; i < LED_COUNT; i++) {
+        while (acc_bits < bits) {
+            acc |= (uint32_t)*p++ << acc_bits;
+            acc_bits += 8;
+        }
+        uint32_t z = acc & mask;
+        acc >>= bits;
+        acc_bits -= bits;
+        level[i] += (uint8_t)((z >> 1) ^ -(z & 1));
+    }
+    return p;
+}
+
+/* ── Validation ── */
+
+static bool read_header(const esp_partition_t *part, clip_header_t *hdr)
+{
+    if (esp_partition_read(part, 0, hdr, sizeof(*hdr)) != ESP_OK) return false;
+    return hdr->magic == CLIP_MAGIC && hdr->version == CLIP_VERSION &&
+           hdr->led_count == LED_COUNT && hdr->frames > 0 &&
+           hdr->data_len <= part->size - sizeof(*hdr);
+}
+
+bool flame_clip_valid(uint32_t key)
+{
+    const esp_partition_t *part = clip_partition();
+    clip_header_t hdr;
+    if (!part || !read_header(part, &hdr) || hdr.key != key) return false;
+
+    const void *ptr;
+    esp_partition_mmap_handle_t map;
+    if (esp_partition_mmap(part, 0, sizeof(hdr) + hdr.data_len, ESP_PARTITION_MMAP_DATA,
+                           &ptr, &map) != ESP_OK) {
+        return false;
+    }
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)ptr + sizeof(hdr), hdr.data_len);
+    esp_partition_munmap(map);
+    return crc == hdr.data_crc;
+}
+
+/* ── Bake ── */
+
+esp_err_t flame_clip_bake(uint32_t key, int frames, int crossfade,
+                          flame_clip_gen_fn gen, void *arg)
+{
+    ESP_RETURN_ON_FALSE(gen && frames > 0 && crossfade >= 0 && crossfade < frames,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid clip length");
+
+    const esp_partition_t *part = clip_partition();
+    ESP_RETURN_ON_FALSE(part, ESP_ERR_NOT_FOUND, TAG, "no '%s' partition", FLAME_CLIP_PARTITION_LABEL);
+
+    size_t worst = sizeof(clip_header_t) + (size_t)frames * CLIP_FRAME_MAX;
+    ESP_RETURN_ON_FALSE(worst <= part->size, ESP_ERR_INVALID_SIZE, TAG,
+                        "%d frames may not fit in %lu bytes", frames, (unsigned long)part->size);
+    size_t erase = (worst + part->erase_size - 1) / part->erase_size * part->erase_size;
+    ESP_RETURN_ON_ERROR(esp_partition_erase_range(part, 0, erase), TAG, "erase failed");
+
+    uint8_t *hold  = malloc(crossfade * LED_COUNT + 1);
+    uint8_t *stage = malloc(CLIP_STAGE_SIZE);
+    if (!hold || !stage) {
+        free(hold);
+        free(stage);
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint8_t prev[LED_COUNT] = {0};
+    uint8_t cur[LED_COUNT];
+    size_t  staged = 0;
+    size_t  offset = sizeof(clip_header_t);
+    uint32_t crc = 0;
+
+    for (int idx = 0; idx < frames + crossfade && ret == ESP_OK; idx++) {
+        gen(idx, cur, arg);
+
+        /* The first crossfade frames only serve as the blend target for
+         * the tail, which fades into them as the clip wraps around */
+        if (idx < crossfade) {
+            memcpy(&hold[idx * LED_COUNT], cur, LED_COUNT);
+            continue;
+        }
+        if (idx >= frames) {
+            int j = idx - frames;
+            uint32_t w = (uint32_t)(j + 1) * 256 / (crossfade + 1);
+            for (int i = 0; i < LED_COUNT; i++) {
+                cur[i] = (uint8_t)((cur[i] * (256 - w) + hold[j * LED_COUNT + i] * w + 128) >> 8);
+            }
+        }
+
+        staged += encode_frame(prev, cur, &stage[staged]);
+        memcpy(prev, cur, LED_COUNT);
+
+        if (staged > CLIP_STAGE_SIZE - CLIP_FRAME_MAX || idx == frames + crossfade - 1) {
+            crc = esp_rom_crc32_le(crc, stage, staged);
+            ret = esp_partition_write(part, offset, stage, staged);
+            offset += staged;
+            staged = 0;
+        }
+    }
+
+    free(hold);
+    free(stage);
+    ESP_RETURN_ON_ERROR(ret, TAG, "write failed");
+
+    clip_header_t hdr = {
+        .magic     = CLIP_MAGIC,
+        .version   = CLIP_VERSION,
+        .led_count = LED_COUNT,
+        .key       = key,
+        .frames    = frames,
+        .data_len  = offset - sizeof(clip_header_t),
+        .data_crc  = crc,
+    };
+    ESP_RETURN_ON_ERROR(esp_partition_write(part, 0, &hdr, sizeof(hdr)), TAG, "header write failed");
+
+    ESP_LOGI(TAG, "Baked %d frames into %lu bytes (%lu%% of raw)", frames,
+             (unsigned long)hdr.data_len,
+             (unsigned long)(hdr.data_len * 100 / ((uint32_t)frames * LED_COUNT)));
+    return ESP_OK;
+}
+
+/* ── Playback ── */
+
+esp_err_t flame_clip_open(void)
+{
+    const esp_partition_t *part = clip_partition();
+    clip_header_t hdr;
+    ESP_RETURN_ON_FALSE(part && read_header(part, &hdr), ESP_ERR_NOT_FOUND, TAG, "no clip");
+
+    const void *ptr;
+    ESP_RETURN_ON_ERROR(esp_partition_mmap(part, 0, sizeof(hdr) + hdr.data_len,
+                                           ESP_PARTITION_MMAP_DATA, &ptr, &s_map),
+                        TAG, "mmap failed");
+    s_data = (const uint8_t *)ptr + sizeof(hdr);
+    s_end  = s_data + hdr.data_len;
+    s_pos  = s_end;         /* first next() rewinds */
+    return ESP_OK;
+}
+
+void flame_clip_next(uint8_t level[LED_COUNT])
+{
+    if (s_pos >= s_end) {
+        s_pos = s_data;
+        memset(s_level, 0, sizeof(s_level));
+    }
+    s_pos = decode_frame(s_pos, s_level);
+    memcpy(level, s_level, LED_COUNT);
+}
+
+void flame_clip_close(void)
+{
+    if (!s_data) return;
+    esp_partition_munmap(s_map);
+    s_data = s_end = s_pos = NULL;
+}
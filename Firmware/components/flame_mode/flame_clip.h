@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "led_driver.h"
+
+/*
+ * Effect clips — a looped sequence of effect-layer intensity maps
+ * (LED_COUNT bytes per frame) stored in the "anim" data partition and
+ * played back through a memory-mapped read, so a long-running effect costs
+ * one delta decode per frame instead of the full computation.
+ *
+ * Partition layout:
+ *   header   32 bytes: magic, version, LED count, key, frame count, data
+ *            length and CRC-32 (written last, so an interrupted bake
+ *            leaves no valid clip)
+ *   frames   per frame: 1 byte bit width b (0–8), then LED_COUNT zig-zag
+ *            coded deltas from the previous frame (mod 256), b bits each,
+ *            packed LSB first.  b = 0: frame identical to the previous one.
+ *            The first frame is coded against all-zero, so playback loops
+ *            by resetting to zero and rewinding.
+ *
+ * Colour, master brightness and fade are not part of the clip — they are
+ * applied by the compositor at render time as for the live effect.
+ */
+
+#define FLAME_CLIP_PARTITION_LABEL  "anim"
+#define FLAME_CLIP_PARTITION_TYPE   0x40    /* data subtype, see partitions.csv */
+
+/**
+ * Frame generator for flame_clip_bake: fill @p level with frame @p index.
+ * Called once per index, in order, from 0 to frames + crossfade − 1.
+ */
+typedef void (*flame_clip_gen_fn)(int index, uint8_t level[LED_COUNT], void *arg);
+
+/**
+ * True if the partition holds an intact clip baked with @p key.
+ */
+bool flame_clip_valid(uint32_t key);
+
+/**
+ * Render a clip of @p frames frames and write it to the partition.
+ *
+ * The generator is run for frames + crossfade frames.  The first crossfade
+ * frames are held back and blended into the last ones, so the end of the
+ * clip runs smoothly into its start.  Blocks for the generator, erase and
+ * write (seconds for a one-minute clip): call from a background task, with
+ * the clip not open.
+ *
+ * @param key  Caller-defined identity of the content (e.g. a config hash),
+ *             checked by flame_clip_valid().
+ */
+esp_err_t flame_clip_bake(uint32_t key, int frames, int crossfade,
+                          flame_clip_gen_fn gen, void *arg);
+
+/**
+ * Map the stored clip for playback and rewind to its first frame.
+ */
+esp_err_t flame_clip_open(void);
+
+/**
+ * Decode the next frame into @p level, wrapping at the end of the clip.
+ * Only valid between flame_clip_open() and flame_clip_close().
+ */
+void flame_clip_next(uint8_t level[LED_COUNT]);
+
+/**
+ * Unmap the clip.
+ */
+void flame_clip_close(void);
@@ -0,0 +1,118 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "flame_fire.h"
+#include "anim_rng.h"
+
+#define FIRE_COLS           FLAME_FIRE_COLS
+#define FIRE_ROWS           FLAME_FIRE_ROWS
+#define FIRE_PERIOD_US      (1000000 / FLAME_FIRE_HZ)
+#define FIRE_MAX_STEPS      4       /* catch-up limit after a late frame */
+#define FIRE_SPARK_ROWS     2       /* sparks land in the bottom rows */
+#define FIRE_SPARK_MIN      160
+
+/* Palette stops: heat → chroma (max channel 255), interpolated into
+ * s_palette.  Embers are deep warm, the core runs to neutral with a touch
+ * of cool at the hottest. */
+static const struct {
+    uint8_t heat;
+    uint8_t warm, neutral, cool;
+} s_stops[] = {
+    {   0, 255,   0,   0 },
+    {  96, 255,  48,   0 },
+    { 160, 255, 150,   0 },
+    { 224, 220, 255,  40 },
+    { 255, 170, 255, 120 },
+};
+#define STOP_COUNT  (sizeof(s_stops) / sizeof(s_stops[0]))
+
+static led_pixel_t s_palette[256];
+static bool        s_palette_ready;
+
+static uint8_t lerp8(uint8_t a, uint8_t b, uint16_t t, uint16_t span)
+{
+    return (uint8_t)(a + ((int16_t)(b - a) * (int32_t)t) / span);
+}
+
+static void build_palette(void)
+{
+    for (size_t s = 0; s + 1 < STOP_COUNT; s++) {
+        uint16_t span = s_stops[s + 1].heat - s_stops[s].heat;
+        for (uint16_t t = 0; t <= span; t++) {
+            led_pixel_t *px = &s_palette[s_stops[s].heat + t];
+            px->warm    = lerp8(s_stops[s].warm,    s_stops[s + 1].warm,    t, span);
+            px->neutral = lerp8(s_stops[s].neutral, s_stops[s + 1].neutral, t, span);
+            px->cool    = lerp8(s_stops[s].cool,    s_stops[s + 1].cool,    t, span);
+        }
+    }
+    s_palette_ready = true;
+}
+
+void flame_fire_reset(flame_fire_state_t *st, uint64_t seed)
+{
+    if (!s_palette_ready) build_palette();
+    anim_rng_seed(&st->rng, seed);
+    memset(st->heat, 0, sizeof(st->heat));
+    st->accum_us = FIRE_PERIOD_US;      /* first frame runs one step */
+}
+
+/* Subtract a random 0..cooling; rnd is 6 bits */
+static inline uint8_t cool_cell(uint8_t h, uint32_t rnd, uint8_t cooling)
+{
+    uint8_t c = (uint8_t)(((rnd & 0x3F) * (cooling + 1u)) >> 6);
+    return h > c ? h - c : 0;
+}
+
+static void fire_tick(flame_fire_state_t *st, const flame_params_t *p)
+{
+    /* Heat rises and cools in one top-down pass: each cell takes a
+     * weighted average of the cells below it (3 × directly below, 1 × each
+     * diagonal, 3 × two below) — top down, so every source is still from
+     * the previous step — less a random cooling.  One RNG word per row.
+     * The cold border means no edge cases, and the flame tapers at the
+     * sides. */
+    for (int y = 0; y < FIRE_ROWS - 1; y++) {
+        const uint8_t *b1 = st->heat[y + 1];
+        const uint8_t *b2 = st->heat[y + 2];
+        uint32_t rnd = anim_rng_u32(&st->rng);
+        for (int x = 1; x <= FIRE_COLS; x++, rnd >>= 6) {
+            uint16_t sum = (uint16_t)(3 * b1[x] + b1[x - 1] + b1[x + 1] + 3 * b2[x]);
+            st->heat[y][x] = cool_cell((uint8_t)(sum >> 3), rnd, p->fire_cooling);
+        }
+    }
+    uint8_t *bottom = st->heat[FIRE_ROWS - 1];
+    uint32_t rnd = anim_rng_u32(&st->rng);
+    for (int x = 1; x <= FIRE_COLS; x++, rnd >>= 6) {
+        bottom[x] = cool_cell(bottom[x], rnd, p->fire_cooling);
+    }
+
+    /* Sparks: one chance per bottom row */
+    for (int r = 0; r < FIRE_SPARK_ROWS; r++) {
+        uint32_t bits = anim_rng_u32(&st->rng);
+        if ((bits & 0xFF) >= p->fire_sparking) continue;
+        uint8_t *h = &st->heat[FIRE_ROWS - 1 - r][1 + (((bits >> 8) & 0xFF) * FIRE_COLS >> 8)];
+        uint16_t v = *h + FIRE_SPARK_MIN + ((((bits >> 16) & 0xFF) * 96) >> 8);   /* +0..95 */
+        *h = v > 255 ? 255 : (uint8_t)v;
+    }
+}
+
+void flame_fire_step(flame_fire_state_t *st, const flame_params_t *p, int32_t dt_us,
+                     uint8_t level[LED_COUNT], led_pixel_t color[LED_COUNT])
+{
+    /* Step at FLAME_FIRE_HZ whatever the frame rate, catching up at most
+     * FIRE_MAX_STEPS after a late frame */
+    if (dt_us > 0) {
+        st->accum_us += dt_us < FIRE_MAX_STEPS * FIRE_PERIOD_US ? dt_us
+                                                                : FIRE_MAX_STEPS * FIRE_PERIOD_US;
+    }
+    while (st->accum_us >= FIRE_PERIOD_US) {
+        st->accum_us -= FIRE_PERIOD_US;
+        fire_tick(st, p);
+    }
+
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint8_t h = st->heat[led_coords[i].row][led_coords[i].col + 1];
+        level[i] = h;
+        color[i] = s_palette[h];
+    }
+}
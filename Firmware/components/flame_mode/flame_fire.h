@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+#include "led_driver.h"
+#include "flame_kernel.h"
+
+/*
+ * Cellular fire — the classic heat-diffusion automaton on the LED grid
+ * (FLAME_STYLE_FIRE).  A byte of heat per cell of the 5 × 7 grid
+ * (led_coords); each step cools every cell by a random amount, moves heat
+ * up from the two rows below, and randomly ignites sparks in the bottom
+ * rows.  Heat maps to effect-layer intensity and, through a palette, to a
+ * per-LED warm/neutral/cool colour.  8- and 16-bit integer arithmetic only.
+ *
+ * The automaton steps at FLAME_FIRE_HZ independent of the render rate
+ * (several steps per frame at LAMP_RENDER_FPS).  As with the flame kernels,
+ * a step is a pure function of (state, params, dt) → frame; the palette is
+ * a constant cache.
+ */
+
+#define FLAME_FIRE_HZ   60
+#define FLAME_FIRE_COLS 5
+#define FLAME_FIRE_ROWS 7       /* row 0 = top */
+
+typedef struct {
+    anim_rng_t rng;
+    /* Heat per cell, plus a cold border (a column either side and a row
+     * below) that is never written */
+    uint8_t    heat[FLAME_FIRE_ROWS + 1][FLAME_FIRE_COLS + 2];
+    int32_t    accum_us;        /* time not yet stepped */
+} flame_fire_state_t;
+
+void flame_fire_reset(flame_fire_state_t *st, uint64_t seed);
+
+/**
+ * Advance the automaton by @p dt_us and map it to the LEDs.  The first
+ * call after reset (dt = 0) runs one step.
+ * @param level  Effect-layer intensity per LED.
+ * @param color  Base-layer colour per LED (palette, full scale).
+ */
+void flame_fire_step(flame_fire_state_t *st, const flame_params_t *p, int32_t dt_us,
+                     uint8_t level[LED_COUNT], led_pixel_t color[LED_COUNT]);
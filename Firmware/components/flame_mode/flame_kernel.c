@@ -0,0 +1,522 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "flame_kernel.h"
+#include "anim_rng.h"
+
+/* Walk bounds and rest position (grid units) */
+#define FLAME_X_MIN         1.0f
+#define FLAME_X_MAX         3.0f
+#define FLAME_Y_MIN         0.5f
+#define FLAME_Y_MAX         5.5f
+#define FLAME_X_REST        2.0f
+#define FLAME_Y_START       2.5f
+
+/* ══════════════════════ Float reference kernel ══════════════════════ */
+
+/* ── Scaled config → float conversion helpers ── */
+/* drift_x/y: 0–255 → 0.0–0.5 */
+#define SCALE_DRIFT(v)      ((float)(v) / 255.0f * 0.5f)
+/* restore: 0–255 → 0.0–0.3 */
+#define SCALE_RESTORE(v)    ((float)(v) / 255.0f * 0.3f)
+/* radius: 0–255 → 0.5–4.0 */
+#define SCALE_RADIUS(v)     (0.5f + (float)(v) / 255.0f * 3.5f)
+/* bias_y: 0–255 → 0.0–6.0 */
+#define SCALE_BIAS_Y(v)     ((float)(v) / 255.0f * 6.0f)
+/* flicker_depth: 0–255 → 0.0–1.0 */
+#define SCALE_FLICKER_D(v)  ((float)(v) / 255.0f)
+/* flicker_speed: 0–255 → 1.0–10.0 Hz */
+#define SCALE_FLICKER_S(v)  (1.0f + (float)(v) / 255.0f * 9.0f)
+
+/* Interval before the next flicker phase re-randomisation: 0.5–2.0 s */
+static int32_t phase_interval_us(anim_rng_t *rng)
+{
+    int frames = FLAME_KERNEL_FPS / 2 + (anim_rng_u32(rng) % (FLAME_KERNEL_FPS * 2));
+    return frames * FLAME_KERNEL_FRAME_US;
+}
+
+/* dt a step integrates over: one nominal frame for the first step, capped */
+static inline int32_t step_dt(int32_t dt_us)
+{
+    if (dt_us <= 0) return FLAME_KERNEL_FRAME_US;
+    return dt_us < FLAME_KERNEL_DT_MAX_US ? dt_us : FLAME_KERNEL_DT_MAX_US;
+}
+
+void flame_kernel_float_reset(flame_state_t *st, uint64_t seed)
+{
+    anim_rng_seed(&st->rng, seed);
+
+    /* Flame centre starts at grid centre */
+    st->fx   = FLAME_X_REST;
+    st->fy   = FLAME_Y_START;
+    st->t_us = 0;
+
+    st->flicker_phase        = 0.0f;
+    st->flicker_phase_target = anim_rng_uniform(&st->rng) * 2.0f * M_PI;
+    st->phase_left_us        = FLAME_KERNEL_FPS * FLAME_KERNEL_FRAME_US;  /* after ~1 s */
+}
+
+void flame_kernel_float_step(flame_state_t *st, const flame_params_t *p,
+                             int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    /* Step length in nominal frames (exactly 1.0f at the nominal rate) */
+    int32_t dt = step_dt(dt_us);
+    float   k  = (float)dt / (float)FLAME_KERNEL_FRAME_US;
+    float   ks = sqrtf(k);
+
+    /* ── Random walk ── */
+    st->fx += p->drift_x * ks * anim_rng_normal(&st->rng) - p->restore * k * (st->fx - FLAME_X_REST);
+    st->fy += p->drift_y * ks * anim_rng_normal(&st->rng) - p->restore * k * (st->fy - p->bias_y);
+
+    /* Clamp to populated region */
+    if (st->fx < FLAME_X_MIN) st->fx = FLAME_X_MIN;
+    if (st->fx > FLAME_X_MAX) st->fx = FLAME_X_MAX;
+    if (st->fy < FLAME_Y_MIN) st->fy = FLAME_Y_MIN;
+    if (st->fy > FLAME_Y_MAX) st->fy = FLAME_Y_MAX;
+
+    /* ── Global flicker ── */
+    st->t_us = (st->t_us + dt_us) % 3600000000LL;
+    float t = (float)st->t_us / 1e6f;
+    float flicker = 1.0f - p->flicker_depth * fabsf(sinf(t * p->flicker_omega + st->flicker_phase));
+
+    /* Re-randomise flicker phase periodically */
+    st->phase_left_us -= dt;
+    if (st->phase_left_us <= 0) {
+        st->flicker_phase = st->flicker_phase_target;
+        st->flicker_phase_target = anim_rng_uniform(&st->rng) * 2.0f * M_PI;
+        st->phase_left_us = phase_interval_us(&st->rng);
+    }
+    /* Smoothly interpolate toward target phase, 5% per nominal frame */
+    float a = 0.05f * k;
+    st->flicker_phase += (st->flicker_phase_target - st->flicker_phase) * (a < 1.0f ? a : 1.0f);
+
+    /* ── Per-LED intensity ── */
+    for (int i = 0; i < LED_COUNT; i++) {
+        float cx = (float)led_coords[i].col;
+        float cy = (float)led_coords[i].row;
+        float dx = cx - st->fx;
+        float dy = cy - st->fy;
+        float d2 = dx * dx + dy * dy;
+
+        /* scale is 0.0–1.0: spatial Gaussian × temporal flicker */
+        float scale = expf(-d2 * p->inv_two_sigma_sq) * flicker;
+        if (scale < 0.0f) scale = 0.0f;
+        if (scale > 1.0f) scale = 1.0f;
+
+        level[i] = (uint8_t)(255.0f * scale);
+    }
+}
+
+void flame_kernel_float_pos(const flame_state_t *st, float *x, float *y)
+{
+    *x = st->fx;
+    *y = st->fy;
+}
+
+/* ══════════════════════ Fixed-point kernel ══════════════════════ */
+
+/*
+ * Formats: positions Q16 (grid units), intensities Q15, phases as unsigned
+ * Q32 turns (2^32 = one full cycle, so wrap-around is free).
+ */
+
+#define Q16(x)              ((int32_t)((x) * 65536.0f))
+#define Q15_ONE             32768
+
+/* Same ranges as the SCALE_* helpers above, in fixed point */
+#define QSCALE_DRIFT(v)     ((int32_t)(v) * Q16(0.5f) / 255)               /* Q16 */
+#define QSCALE_RESTORE(v)   ((int32_t)(v) * Q16(0.3f) / 255)               /* Q16 */
+#define QSCALE_RADIUS(v)    (Q16(0.5f) + (int32_t)(v) * Q16(3.5f) / 255)   /* Q16 */
+#define QSCALE_BIAS_Y(v)    ((int32_t)(v) * Q16(6.0f) / 255)               /* Q16 */
+#define QSCALE_FLICKER_D(v) ((int32_t)(v) * Q15_ONE / 255)                 /* Q15 */
+#define QSCALE_FLICKER_S(v) (256 + (int32_t)(v) * 9 * 256 / 255)           /* Hz, Q8 */
+
+/* Below these the flame barely moves: walk σ of 1% of an LED pitch per
+ * frame, 2% flicker */
+#define STILL_DRIFT         Q16(0.01f)
+#define STILL_FLICKER       (Q15_ONE / 50)
+
+/* Cellular fire: a bigger radius cools less (taller flame), a faster
+ * flicker sparks more often */
+#define FIRE_COOLING(v)     ((uint8_t)(40 - (v) * 32 / 255))                /* 40–8 */
+#define FIRE_SPARKING(v)    ((uint8_t)(96 + (v) * 128 / 255))               /* 96–224 */
+
+/* exp(-x) for x in [0, EXP_X_MAX): EXP_LUT_SIZE segments, linearly
+ * interpolated.  exp(-8) < 1/2048, below one 8-bit output step. */
+#define EXP_LUT_BITS        6
+#define EXP_LUT_SIZE        (1 << EXP_LUT_BITS)
+#define EXP_X_MAX_Q16       Q16(8.0f)
+#define EXP_SEG_SHIFT       (16 + 3 - EXP_LUT_BITS)      /* Q16 x → segment */
+
+/* sin over one full turn: SIN_LUT_SIZE segments, linearly interpolated */
+#define SIN_LUT_BITS        8
+#define SIN_LUT_SIZE        (1 << SIN_LUT_BITS)
+
+/* Read-only once built (flame_kernel_init) */
+static int16_t s_exp_lut[EXP_LUT_SIZE + 1];     /* Q15 */
+static int16_t s_sin_lut[SIN_LUT_SIZE + 1];     /* Q15, saturated at ±32767 */
+static bool    s_luts_ready;
+
+void flame_kernel_init(void)
+{
+    if (s_luts_ready) return;
+    for (int i = 0; i <= EXP_LUT_SIZE; i++) {
+        float x = 8.0f * i / EXP_LUT_SIZE;
+        s_exp_lut[i] = (int16_t)lroundf(fminf(expf(-x) * Q15_ONE, 32767.0f));
+    }
+    for (int i = 0; i <= SIN_LUT_SIZE; i++) {
+        float a = 2.0f * M_PI * i / SIN_LUT_SIZE;
+        s_sin_lut[i] = (int16_t)lroundf(fmaxf(fminf(sinf(a) * Q15_ONE, 32767.0f), -32767.0f));
+    }
+    s_luts_ready = true;
+}
+
+/* exp(-x), x in Q16 ≥ 0 → Q15 */
+static inline int32_t exp_neg_q15(int32_t x_q16)
+{
+    if (x_q16 >= EXP_X_MAX_Q16) return 0;
+    int32_t seg  = x_q16 >> EXP_SEG_SHIFT;
+    int32_t frac = x_q16 & ((1 << EXP_SEG_SHIFT) - 1);
+    int32_t a = s_exp_lut[seg];
+    int32_t b = s_exp_lut[seg + 1];
+    return a + (((b - a) * frac) >> EXP_SEG_SHIFT);
+}
+
+/* sin(2π · turns), turns in Q32 → Q15 */
+static inline int32_t sin_q15(uint32_t turns)
+{
+    uint32_t seg  = turns >> (32 - SIN_LUT_BITS);
+    int32_t  frac = (turns >> (32 - SIN_LUT_BITS - 15)) & 0x7FFF;    /* Q15 */
+    int32_t  a = s_sin_lut[seg];
+    int32_t  b = s_sin_lut[seg + 1];
+    return a + (((b - a) * frac) >> 15);
+}
+
+/* exp(-d² / 2σ²) for LED i and a hot-spot at (x, y) in Q16 → Q15 */
+static inline int32_t spot_q15(int i, int32_t x_q16, int32_t y_q16, int32_t inv_2s2)
+{
+    int32_t dx = ((int32_t)led_coords[i].col << 8) - (x_q16 >> 8);     /* Q8 */
+    int32_t dy = ((int32_t)led_coords[i].row << 8) - (y_q16 >> 8);
+    int32_t d2 = dx * dx + dy * dy;                                     /* Q16 */
+    return exp_neg_q15((int32_t)(((int64_t)d2 * inv_2s2) >> 16));
+}
+
+#if CONFIG_FLAME_MODE_ATLAS
+/*
+ * Gaussian atlas — the hot-spot is clamped to a fixed rectangle and the LED
+ * positions never move, so for a given radius the spatial term is a pure
+ * function of the hot-spot position.  Tabulate it once per radius at
+ * ATLAS_STEPS points per grid cell; each frame then blends the four
+ * surrounding rows (31 bytes each) instead of evaluating exp per LED.
+ *
+ * Layout: atlas[(iy * ATLAS_NX + ix) * LED_COUNT + led], 0–255.
+ */
+#define ATLAS_STEPS         CONFIG_FLAME_MODE_ATLAS_STEPS
+#define ATLAS_NX            ((int)(FLAME_X_MAX - FLAME_X_MIN) * ATLAS_STEPS + 1)
+#define ATLAS_NY            ((int)(FLAME_Y_MAX - FLAME_Y_MIN) * ATLAS_STEPS + 1)
+#define ATLAS_BYTES         (ATLAS_NX * ATLAS_NY * LED_COUNT)
+
+/* Make sure the state's atlas matches the radius in p.  Rebuilt by the
+ * step that first sees a new radius, on the task that owns the state, so
+ * it is never read half-written. */
+static bool atlas_prepare(flame_state_t *st, const flame_params_t *p)
+{
+    if (st->atlas && st->atlas_radius == p->radius) return true;
+
+    if (!st->atlas) {
+        st->atlas = malloc(ATLAS_BYTES);
+        if (!st->atlas) return false;   /* fall back to per-LED exp */
+    }
+
+    uint8_t *row = st->atlas;
+    for (int iy = 0; iy < ATLAS_NY; iy++) {
+        int32_t y = Q16(FLAME_Y_MIN) + iy * (65536 / ATLAS_STEPS);
+        for (int ix = 0; ix < ATLAS_NX; ix++) {
+            int32_t x = Q16(FLAME_X_MIN) + ix * (65536 / ATLAS_STEPS);
+            for (int i = 0; i < LED_COUNT; i++) {
+                row[i] = (uint8_t)((spot_q15(i, x, y, p->q_inv_2s2) * 255 + (Q15_ONE / 2)) >> 15);
+            }
+            row += LED_COUNT;
+        }
+    }
+    st->atlas_radius = p->radius;
+    return true;
+}
+
+/* Bilinear blend of the four atlas rows around (x, y), times flicker */
+static void atlas_sample(const uint8_t *atlas, int32_t x_q16, int32_t y_q16,
+                         int32_t flicker, uint8_t level[LED_COUNT])
+{
+    /* Position in atlas cells, Q8 */
+    int32_t ux = (int32_t)(((int64_t)(x_q16 - Q16(FLAME_X_MIN)) * ATLAS_STEPS) >> 8);
+    int32_t uy = (int32_t)(((int64_t)(y_q16 - Q16(FLAME_Y_MIN)) * ATLAS_STEPS) >> 8);
+    int32_t ix = ux >> 8, fx = ux & 0xFF;
+    int32_t iy = uy >> 8, fy = uy & 0xFF;
+    if (ix >= ATLAS_NX - 1) { ix = ATLAS_NX - 2; fx = 256; }
+    if (iy >= ATLAS_NY - 1) { iy = ATLAS_NY - 2; fy = 256; }
+
+    const uint8_t *r00 = atlas + (iy * ATLAS_NX + ix) * LED_COUNT;
+    const uint8_t *r01 = r00 + LED_COUNT;
+    const uint8_t *r10 = r00 + ATLAS_NX * LED_COUNT;
+    const uint8_t *r11 = r10 + LED_COUNT;
+
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint32_t top = r00[i] * (256 - fx) + r01[i] * fx;               /* Q8 */
+        uint32_t bot = r10[i] * (256 - fx) + r11[i] * fx;
+        uint32_t v   = (top * (256 - fy) + bot * fy) >> 8;              /* Q8 */
+        level[i] = (uint8_t)((v * (uint32_t)flicker + (1u << 22)) >> 23);
+    }
+}
+#endif
+
+void flame_kernel_release(flame_state_t *st)
+{
+    free(st->atlas);
+    st->atlas = NULL;
+}
+
+/* ── Embers (particle style) ──
+ *
+ * Small hot-spots that spawn around the main one, rise with a little
+ * sideways jitter and cool exponentially.  They live in a fixed pool in
+ * the state — a stack of free indices for O(1) allocate/free and a dense
+ * list of live indices for iteration (removal swaps in the last entry) —
+ * so the render loop never touches the heap.
+ */
+#define EMBER_INV_2S2       Q16(1.0f / (2.0f * 0.6f * 0.6f))    /* σ = 0.6 grid units */
+#define EMBER_SPAWN_P       (UINT32_MAX / 3)                    /* per frame */
+#define EMBER_SPREAD        Q16(0.4f)                           /* spawn offset σ (x) */
+#define EMBER_LIFT          Q16(0.8f)                           /* spawn above the spot */
+#define EMBER_RISE_MIN      Q16(0.04f)                          /* grid units / frame */
+#define EMBER_RISE_RANGE    Q16(0.08f)
+#define EMBER_JITTER        Q16(0.03f)                          /* sideways step σ */
+#define EMBER_HEAT_MIN      (Q15_ONE * 25 / 100)
+#define EMBER_HEAT_RANGE    (Q15_ONE * 30 / 100)
+#define EMBER_COOL          (Q15_ONE * 92 / 100)                /* heat kept per frame */
+#define EMBER_DEAD          (Q15_ONE * 4 / 100)
+
+static void ember_pool_reset(flame_state_t *st)
+{
+    for (int k = 0; k < FLAME_KERNEL_EMBERS; k++) st->ember_free[k] = k;
+    st->ember_free_n = FLAME_KERNEL_EMBERS;
+    st->ember_live_n = 0;
+}
+
+static flame_ember_t *ember_alloc(flame_state_t *st)
+{
+    if (!st->ember_free_n) return NULL;
+    uint8_t k = st->ember_free[--st->ember_free_n];
+    st->ember_live[st->ember_live_n++] = k;
+    return &st->ember[k];
+}
+
+/* Free the ember at position n of the live list */
+static void ember_free(flame_state_t *st, int n)
+{
+    st->ember_free[st->ember_free_n++] = st->ember_live[n];
+    st->ember_live[n] = st->ember_live[--st->ember_live_n];
+}
+
+void flame_kernel_q15_reset(flame_state_t *st, uint64_t seed)
+{
+    anim_rng_seed(&st->rng, seed);
+    flame_kernel_init();
+
+    st->qx = Q16(FLAME_X_REST);
+    st->qy = Q16(FLAME_Y_START);
+
+    st->flicker_turns  = 0;
+    st->qphase         = 0;
+    st->qphase_target  = anim_rng_u32(&st->rng);
+    st->phase_left_us  = FLAME_KERNEL_FPS * FLAME_KERNEL_FRAME_US;
+    ember_pool_reset(st);
+}
+
+/* Integer square root (floor) */
+static uint32_t isqrt32(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t b = 1u << 30; b; b >>= 2) {
+        if (v >= r + b) {
+            v -= r + b;
+            r = (r >> 1) + b;
+        } else {
+            r >>= 1;
+        }
+    }
+    return r;
+}
+
+/* Step length in nominal frames: k (Q16, exactly 1.0 at the nominal rate)
+ * and √k (Q16, from a Q8 root — also exact at 1.0) */
+typedef struct {
+    int32_t dt_us;
+    int32_t k;
+    int32_t ks;
+} q15_scale_t;
+
+static q15_scale_t q15_scale(int32_t dt_us)
+{
+    q15_scale_t s;
+    s.dt_us = step_dt(dt_us);
+    s.k     = (int32_t)(((int64_t)s.dt_us << 16) / FLAME_KERNEL_FRAME_US);
+    s.ks    = (int32_t)(isqrt32((uint32_t)s.k) << 8);
+    return s;
+}
+
+/* Walk and flicker oscillator for one step → flicker gain (Q15) */
+static int32_t q15_advance(flame_state_t *st, const flame_params_t *p, int32_t dt_us,
+                           const q15_scale_t *sc)
+{
+    /* ── Random walk (Q16) ── */
+    int32_t drift_x = (int32_t)(((int64_t)p->q_drift_x * sc->ks) >> 16);
+    int32_t drift_y = (int32_t)(((int64_t)p->q_drift_y * sc->ks) >> 16);
+    int32_t restore = (int32_t)(((int64_t)p->q_restore * sc->k) >> 16);
+    st->qx += (int32_t)(((int64_t)anim_rng_normal_q15(&st->rng) * drift_x) >> 15)
+            - (int32_t)(((int64_t)restore * (st->qx - Q16(FLAME_X_REST))) >> 16);
+    st->qy += (int32_t)(((int64_t)anim_rng_normal_q15(&st->rng) * drift_y) >> 15)
+            - (int32_t)(((int64_t)restore * (st->qy - p->q_bias_y)) >> 16);
+
+    if (st->qx < Q16(FLAME_X_MIN)) st->qx = Q16(FLAME_X_MIN);
+    if (st->qx > Q16(FLAME_X_MAX)) st->qx = Q16(FLAME_X_MAX);
+    if (st->qy < Q16(FLAME_Y_MIN)) st->qy = Q16(FLAME_Y_MIN);
+    if (st->qy > Q16(FLAME_Y_MAX)) st->qy = Q16(FLAME_Y_MAX);
+
+    /* ── Global flicker ──
+     * Advance the oscillator by dt × speed instead of evaluating
+     * sin(t · speed) from absolute time: same waveform, no float t. */
+    if (dt_us > 0) {
+        st->flicker_turns += (uint32_t)(((uint64_t)dt_us * (uint64_t)p->q_flicker_speed << 24) / 1000000);
+    }
+
+    int32_t s = sin_q15(st->flicker_turns + st->qphase);
+    if (s < 0) s = -s;
+    int32_t flicker = Q15_ONE - ((p->q_flicker_depth * s) >> 15);                /* Q15 */
+
+    /* Re-randomise flicker phase periodically */
+    st->phase_left_us -= sc->dt_us;
+    if (st->phase_left_us <= 0) {
+        st->qphase        = st->qphase_target;
+        st->qphase_target = anim_rng_u32(&st->rng);
+        st->phase_left_us = phase_interval_us(&st->rng);
+    }
+    /* Smoothly move 5% per nominal frame toward the target phase (linear,
+     * like the float path) */
+    int32_t a = (int32_t)((3277LL * sc->k) >> 16);
+    if (a > 65536) a = 65536;
+    st->qphase += (uint32_t)((((int64_t)st->qphase_target - (int64_t)st->qphase) * a) >> 16);
+    return flicker;
+}
+
+/* Main hot-spot intensity map */
+static void q15_spot(flame_state_t *st, const flame_params_t *p, int32_t flicker,
+                     uint8_t level[LED_COUNT])
+{
+#if CONFIG_FLAME_MODE_ATLAS
+    if (atlas_prepare(st, p)) {
+        atlas_sample(st->atlas, st->qx, st->qy, flicker, level);
+        return;
+    }
+#endif
+    for (int i = 0; i < LED_COUNT; i++) {
+        int32_t v = (spot_q15(i, st->qx, st->qy, p->q_inv_2s2) * flicker) >> 15;  /* Q15 */
+        if (v < 0) v = 0;
+        if (v > Q15_ONE) v = Q15_ONE;
+        level[i] = (uint8_t)((v * 255) >> 15);
+    }
+}
+
+void flame_kernel_q15_step(flame_state_t *st, const flame_params_t *p,
+                           int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    q15_scale_t sc = q15_scale(dt_us);
+    q15_spot(st, p, q15_advance(st, p, dt_us, &sc), level);
+}
+
+void flame_kernel_particles_step(flame_state_t *st, const flame_params_t *p,
+                                 int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    q15_scale_t sc = q15_scale(dt_us);
+    int32_t flicker = q15_advance(st, p, dt_us, &sc);
+    q15_spot(st, p, flicker, level);
+
+    /* Per-step ember constants, scaled from per nominal frame */
+    uint64_t spawn_p = ((uint64_t)EMBER_SPAWN_P * (uint32_t)sc.k) >> 16;
+    int32_t  jitter  = (int32_t)(((int64_t)EMBER_JITTER * sc.ks) >> 16);
+    int32_t  cool    = Q15_ONE - (int32_t)(((int64_t)(Q15_ONE - EMBER_COOL) * sc.k) >> 16);
+    if (cool < 0) cool = 0;
+
+    /* Spawn at the hot-spot while the pool has room */
+    if (anim_rng_u32(&st->rng) < spawn_p) {
+        flame_ember_t *e = ember_alloc(st);
+        if (e) {
+            e->x    = st->qx + (int32_t)(((int64_t)anim_rng_normal_q15(&st->rng) * EMBER_SPREAD) >> 15);
+            e->y    = st->qy - EMBER_LIFT;
+            e->rise = EMBER_RISE_MIN + (int32_t)(anim_rng_u32(&st->rng) % EMBER_RISE_RANGE);
+            e->heat = EMBER_HEAT_MIN + (int32_t)(anim_rng_u32(&st->rng) % EMBER_HEAT_RANGE);
+        }
+    }
+
+    /* Move, cool and accumulate; row 0 is the top, so rising is −y */
+    int32_t acc[LED_COUNT] = {0};                                       /* Q15 */
+    for (int n = 0; n < st->ember_live_n; ) {
+        flame_ember_t *e = &st->ember[st->ember_live[n]];
+        e->x   += (int32_t)(((int64_t)anim_rng_normal_q15(&st->rng) * jitter) >> 15);
+        e->y   -= (int32_t)(((int64_t)e->rise * sc.k) >> 16);
+        e->heat = (e->heat * cool) >> 15;
+        if (e->heat < EMBER_DEAD || e->y < Q16(-1.0f)) {
+            ember_free(st, n);
+            continue;
+        }
+        for (int i = 0; i < LED_COUNT; i++) {
+            acc[i] += (spot_q15(i, e->x, e->y, EMBER_INV_2S2) * e->heat) >> 15;
+        }
+        n++;
+    }
+
+    /* Embers add to the hot-spot under the same flicker, saturating */
+    for (int i = 0; i < LED_COUNT; i++) {
+        int32_t v = level[i] + ((((acc[i] * flicker) >> 15) * 255) >> 15);
+        level[i] = (uint8_t)(v > 255 ? 255 : v);
+    }
+}
+
+void flame_kernel_q15_pos(const flame_state_t *st, float *x, float *y)
+{
+    *x = st->qx / 65536.0f;
+    *y = st->qy / 65536.0f;
+}
+
+/* ══════════════════════ Derived parameters ══════════════════════ */
+
+void flame_kernel_derive(const flame_config_t *cfg, flame_params_t *out)
+{
+    float sigma = SCALE_RADIUS(cfg->radius);
+
+    out->radius           = cfg->radius;
+
+    out->drift_x          = SCALE_DRIFT(cfg->drift_x);
+    out->drift_y          = SCALE_DRIFT(cfg->drift_y);
+    out->restore          = SCALE_RESTORE(cfg->restore);
+    out->bias_y           = SCALE_BIAS_Y(cfg->bias_y);
+    out->inv_two_sigma_sq = 1.0f / (2.0f * sigma * sigma);
+    out->flicker_depth    = SCALE_FLICKER_D(cfg->flicker_depth);
+    out->flicker_omega    = SCALE_FLICKER_S(cfg->flicker_speed) * 2.0f * M_PI;
+
+    /* 1 / 2σ² in Q16 from σ in Q16 */
+    int32_t q_sigma       = QSCALE_RADIUS(cfg->radius);
+    int64_t two_sigma_sq  = ((int64_t)q_sigma * q_sigma) >> 15;
+    out->q_drift_x        = QSCALE_DRIFT(cfg->drift_x);
+    out->q_drift_y        = QSCALE_DRIFT(cfg->drift_y);
+    out->q_restore        = QSCALE_RESTORE(cfg->restore);
+    out->q_bias_y         = QSCALE_BIAS_Y(cfg->bias_y);
+    out->q_inv_2s2        = (int32_t)(((int64_t)1 << 32) / two_sigma_sq);
+    out->q_flicker_depth  = QSCALE_FLICKER_D(cfg->flicker_depth);
+    out->q_flicker_speed  = QSCALE_FLICKER_S(cfg->flicker_speed);
+    out->still            = out->q_drift_x <= STILL_DRIFT && out->q_drift_y <= STILL_DRIFT &&
+                            out->q_flicker_depth <= STILL_FLICKER;
+
+    out->fire_cooling     = FIRE_COOLING(cfg->radius);
+    out->fire_sparking    = FIRE_SPARKING(cfg->flicker_speed);
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "led_driver.h"
+#include "lamp_render.h"
+#include "lamp_nvs.h"
+#include "anim_rng.h"
+
+/*
+ * Flame kernel — random-walk hot-spot + global flicker → per-LED intensity.
+ * Two interchangeable implementations are always built (so they can be
+ * benchmarked against each other); CONFIG_FLAME_MODE_KERNEL_* selects the
+ * one flame_mode runs.
+ *
+ * Each step is a pure function of (state, params, dt) → frame: everything
+ * that evolves, including the anim_rng all noise comes from, lives in a
+ * caller-owned flame_state_t, so the same seed, params and dt sequence
+ * reproduce the same frames on the lamp and on a host build
+ * (test_apps/flame_trace).  The exp/sin tables are constants, built once
+ * by flame_kernel_init(); the Gaussian atlas is a cache derived from the
+ * params, kept in the state (not reset) so that kernels stepping on
+ * different tasks — the live flame and a clip bake — never share one.
+ *
+ * Params are per nominal frame (FLAME_KERNEL_FPS); a step scales them by
+ * dt — walk noise by √dt, pull, phase smoothing and ember motion by dt —
+ * so the flame moves at the same speed whatever rate the render task runs
+ * at, and a step of exactly one nominal frame is unchanged.  The first
+ * step after reset takes dt = 0 and advances the walk by one nominal frame;
+ * dt is capped at FLAME_KERNEL_DT_MAX_US after a stall.
+ */
+
+#define FLAME_KERNEL_FPS        LAMP_RENDER_FPS
+#define FLAME_KERNEL_FRAME_US   (1000000 / FLAME_KERNEL_FPS)
+#define FLAME_KERNEL_DT_MAX_US  (4 * FLAME_KERNEL_FRAME_US)
+
+/* flame_config_t converted to the units each kernel works in.  Derived
+ * once per config change (flame_kernel_derive) rather than per frame. */
+typedef struct {
+    uint8_t radius;             /* raw config value — atlas cache key */
+    bool    still;              /* walk and flicker too small to show at 15 fps */
+
+    /* float kernel */
+    float   drift_x;            /* walk step σ, grid units */
+    float   drift_y;
+    float   restore;            /* pull toward rest position per frame */
+    float   bias_y;             /* vertical rest position */
+    float   inv_two_sigma_sq;   /* 1 / 2σ² of the hot-spot */
+    float   flicker_depth;      /* 0–1 */
+    float   flicker_omega;      /* rad/s */
+
+    /* fixed-point kernel */
+    int32_t q_drift_x;          /* Q16 */
+    int32_t q_drift_y;          /* Q16 */
+    int32_t q_restore;          /* Q16 */
+    int32_t q_bias_y;           /* Q16 */
+    int32_t q_inv_2s2;          /* Q16 */
+    int32_t q_flicker_depth;    /* Q15 */
+    int32_t q_flicker_speed;    /* Hz, Q8 */
+
+    /* cellular fire (flame_fire.c) */
+    uint8_t fire_cooling;       /* max heat lost per cell per step */
+    uint8_t fire_sparking;      /* spark chance per step, /256 */
+} flame_params_t;
+
+#define FLAME_KERNEL_EMBERS CONFIG_FLAME_MODE_PARTICLES
+
+typedef struct {
+    int32_t x, y;               /* Q16 */
+    int32_t rise;               /* Q16 per frame */
+    int32_t heat;               /* Q15 */
+} flame_ember_t;
+
+/* Everything a kernel step reads and writes besides its params */
+typedef struct {
+    anim_rng_t rng;
+
+    /* float kernel */
+    float    fx, fy;            /* hot-spot, grid units */
+    float    flicker_phase;     /* smoothed random phase offset, rad */
+    float    flicker_phase_target;
+    int64_t  t_us;              /* time since reset */
+
+    /* fixed-point kernel */
+    int32_t  qx, qy;            /* hot-spot, Q16 */
+    uint32_t flicker_turns;     /* flicker oscillator phase, Q32 turns */
+    uint32_t qphase;            /* smoothed random phase offset, Q32 turns */
+    uint32_t qphase_target;
+
+    /* both: time until the phase offset is re-randomised */
+    int32_t  phase_left_us;
+
+    /* particle style: pool of embers — free-index stack, dense live list */
+    flame_ember_t ember[FLAME_KERNEL_EMBERS];
+    uint8_t  ember_free[FLAME_KERNEL_EMBERS];
+    uint8_t  ember_live[FLAME_KERNEL_EMBERS];
+    uint8_t  ember_free_n;
+    uint8_t  ember_live_n;
+
+    /* fixed-point kernel: spatial cache for one radius, kept across resets
+     * (flame_kernel_release frees it) */
+    uint8_t *atlas;
+    int16_t  atlas_radius;
+} flame_state_t;
+
+/* Build the exp/sin tables.  Call once before stepping kernels on more
+ * than one task; the resets build them on first use otherwise. */
+void flame_kernel_init(void);
+
+/* Free the state's atlas; the next fixed-point step rebuilds it */
+void flame_kernel_release(flame_state_t *st);
+
+void flame_kernel_derive(const flame_config_t *cfg, flame_params_t *out);
+
+/* Single-precision float / libm reference */
+void flame_kernel_float_reset(flame_state_t *st, uint64_t seed);
+void flame_kernel_float_step(flame_state_t *st, const flame_params_t *p,
+                             int32_t dt_us, uint8_t level[LED_COUNT]);
+void flame_kernel_float_pos(const flame_state_t *st, float *x, float *y);
+
+/* Q15 / Q16 fixed point with interpolated exp(-x) and sin tables.  With
+ * CONFIG_FLAME_MODE_ATLAS the spatial term comes from a per-radius table
+ * in the state (rebuilt inside step when p->radius changes). */
+void flame_kernel_q15_reset(flame_state_t *st, uint64_t seed);
+void flame_kernel_q15_step(flame_state_t *st, const flame_params_t *p,
+                           int32_t dt_us, uint8_t level[LED_COUNT]);
+void flame_kernel_q15_pos(const flame_state_t *st, float *x, float *y);
+
+/* Particle style: the fixed-point hot-spot plus up to FLAME_KERNEL_EMBERS
+ * embers that spawn at it, rise and cool, held in the state's fixed pool.
+ * Runs on q15 state — reset with flame_kernel_q15_reset() on every build,
+ * whichever kernel is selected. */
+void flame_kernel_particles_step(flame_state_t *st, const flame_params_t *p,
+                                 int32_t dt_us, uint8_t level[LED_COUNT]);
+
+#if CONFIG_FLAME_MODE_KERNEL_FLOAT
+#define flame_kernel_reset  flame_kernel_float_reset
+#define flame_kernel_step   flame_kernel_float_step
+#define flame_kernel_pos    flame_kernel_float_pos
+#else
+#define flame_kernel_reset  flame_kernel_q15_reset
+#define flame_kernel_step   flame_kernel_q15_step
+#define flame_kernel_pos    flame_kernel_q15_pos
+#endif
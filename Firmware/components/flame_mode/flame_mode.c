@@ -1,38 +1,46 @@
-#include <math.h>
 #include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "flame_mode.h"
+#include "flame_kernel.h"
+#include "flame_clip.h"
+#include "flame_fire.h"
 #include "led_driver.h"
+#include "lamp_render.h"
 #include "lamp_nvs.h"
 #include "esp_log.h"
 #include "esp_random.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#if CONFIG_FLAME_MODE_KERNEL_BENCH
+#include <math.h>
+#include "esp_cpu.h"
+#include "anim_rng.h"
+#endif
 
 static const char *TAG = "flame";
 
-#define FLAME_TASK_STACK    4096
-#define FLAME_TASK_PRIO     4
-#define FLAME_FPS           30
-#define FLAME_PERIOD_MS     (1000 / FLAME_FPS)
-
-/* ── Scaled config → float conversion helpers ── */
-/* drift_x/y: 0–255 → 0.0–0.5 */
-#define SCALE_DRIFT(v)      ((float)(v) / 255.0f * 0.5f)
-/* restore: 0–255 → 0.0–0.3 */
-#define SCALE_RESTORE(v)    ((float)(v) / 255.0f * 0.3f)
-/* radius: 0–255 → 0.5–4.0 */
-#define SCALE_RADIUS(v)     (0.5f + (float)(v) / 255.0f * 3.5f)
-/* bias_y: 0–255 → 0.0–6.0 */
-#define SCALE_BIAS_Y(v)     ((float)(v) / 255.0f * 6.0f)
-/* flicker_depth: 0–255 → 0.0–1.0 */
-#define SCALE_FLICKER_D(v)  ((float)(v) / 255.0f)
-/* flicker_speed: 0–255 → 1.0–10.0 Hz */
-#define SCALE_FLICKER_S(v)  (1.0f + (float)(v) / 255.0f * 9.0f)
-
-static TaskHandle_t      s_task = NULL;
-static volatile bool     s_running;
-static SemaphoreHandle_t s_task_done;    /* signalled when flame task exits */
+#define FLAME_FPS           FLAME_KERNEL_FPS
+
+/* Baked clip: length, loop crossfade and the fixed seed it is rendered with */
+#define CLIP_FRAMES         (CONFIG_FLAME_MODE_CLIP_SECONDS * FLAME_FPS)
+#define CLIP_CROSSFADE      CONFIG_FLAME_MODE_CLIP_CROSSFADE_FRAMES
+#define CLIP_SEED           0x466C616D65ULL
+
+/* Background bake task: below every other task, off the render core */
+#define BAKE_TASK_STACK     4096
+#define BAKE_TASK_PRIO      1
+
+/* Kernel build that rendered a clip — part of its key */
+#if CONFIG_FLAME_MODE_KERNEL_FLOAT
+#define CLIP_KERNEL_ID      0
+#elif CONFIG_FLAME_MODE_ATLAS
+#define CLIP_KERNEL_ID      (0x80 | CONFIG_FLAME_MODE_ATLAS_STEPS)
+#else
+#define CLIP_KERNEL_ID      1
+#endif
+
 static flame_config_t    s_cfg = {
     .drift_x       = FLAME_DRIFT_X_DEFAULT,
     .drift_y       = FLAME_DRIFT_Y_DEFAULT,
@@ -42,218 +50,508 @@ static flame_config_t    s_cfg = {
     .flicker_depth = FLAME_FLICKER_DEPTH_DEFAULT,
     .flicker_speed = FLAME_FLICKER_SPEED_DEFAULT,
 };
-static volatile uint8_t  s_master_override = 255;
-static volatile uint8_t  s_scene_master = 255;   /* global brightness from scene.master */
 
-/* Base colour values (0–255) — set from active scene */
-static volatile uint8_t s_color_w = 255;
-static volatile uint8_t s_color_n = 0;
-static volatile uint8_t s_color_c = 0;
+/* Config handoff.  Writers (BLE / control task) derive the kernel
+ * constants once per change and publish them under s_cfg_lock; the render
+ * task reads them lock-free with a sequence counter (odd = write in
+ * progress) and only copies when the sequence has moved. */
+static portMUX_TYPE      s_cfg_lock = portMUX_INITIALIZER_UNLOCKED;
+static flame_params_t    s_params;
+static _Atomic uint32_t  s_params_seq;           /* 0 = nothing published yet */
+static flame_params_t    s_anim_params;          /* render task's copy */
+static uint32_t          s_anim_seq;
 
-/* ── Gaussian random (Box-Muller) ── */
+static uint64_t          s_seed;                 /* 0 = fresh random seed per start */
 
-static float randf_uniform(void)
+/* ── Config handoff ── */
+
+static void params_publish(const flame_config_t *cfg)
 {
-    /* esp_random() returns uint32_t, uniform over full range */
-    return (float)(esp_random() >> 8) / (float)(1 << 24);
+    flame_params_t p;
+    flame_kernel_derive(cfg, &p);
+
+    taskENTER_CRITICAL(&s_cfg_lock);
+    uint32_t seq = atomic_load_explicit(&s_params_seq, memory_order_relaxed);
+    atomic_store_explicit(&s_params_seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s_cfg    = *cfg;
+    s_params = p;
+    atomic_store_explicit(&s_params_seq, seq + 2, memory_order_release);
+    taskEXIT_CRITICAL(&s_cfg_lock);
 }
 
-static float randf_gaussian(float mean, float stddev)
+/* Refresh s_anim_params if a new config was published.  Render task only. */
+static void params_update(void)
 {
-    float u1 = randf_uniform();
-    float u2 = randf_uniform();
-    if (u1 < 1e-10f) u1 = 1e-10f;
-    float z = sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
-    return mean + stddev * z;
+    uint32_t seq = atomic_load_explicit(&s_params_seq, memory_order_acquire);
+    if (seq == s_anim_seq) return;
+
+    flame_params_t p;
+    for (;;) {
+        /* A writer holds s_cfg_lock for a few hundred cycles at most */
+        if (seq & 1) {
+            seq = atomic_load_explicit(&s_params_seq, memory_order_acquire);
+            continue;
+        }
+        p = s_params;
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t again = atomic_load_explicit(&s_params_seq, memory_order_relaxed);
+        if (again == seq) break;
+        seq = again;
+    }
+    s_anim_params = p;
+    s_anim_seq    = seq;
+}
+
+/* ── Flame effect ── */
+
+static int64_t s_diag_us;        /* time since the last diagnostic dump */
+
+/* Style being rendered (FLAME_STYLE_*), chosen at start.  BAKED only once
+ * the clip is mapped; then the key of the clip being played and the config
+ * sequence it was checked against.  s_play_wait: rendering live until the
+ * background bake of s_play_key has finished. */
+static uint8_t  s_style;
+static uint32_t s_play_key;
+static uint32_t s_play_seq;
+static bool     s_play_wait;
+static uint64_t s_play_seed;        /* seed for the live fallback */
+
+/* Background bake, under s_bake_lock.  Jobs are only queued at start, with
+ * no clip mapped, and the render task only maps the clip while the bake
+ * task is idle, so a mapping never overlaps an erase. */
+static TaskHandle_t   s_bake_task;
+static portMUX_TYPE   s_bake_lock = portMUX_INITIALIZER_UNLOCKED;
+static flame_config_t s_bake_cfg;           /* latest job */
+static uint32_t       s_bake_key;
+static bool           s_bake_busy;          /* job taken, not finished */
+static bool           s_baked;              /* partition holds s_baked_key */
+static uint32_t       s_baked_key;
+
+/* Render task: frame state of the style in use and the previous frame time */
+static flame_state_t      s_state;
+static flame_fire_state_t s_fire_state;
+static int64_t            s_last_t_us;
+
+static led_pixel_t s_fire_color[LED_COUNT];     /* fire style palette output */
+
+/* Baked playback: the clip frame on show and time not yet played */
+static uint8_t s_clip_level[LED_COUNT];
+static int32_t s_clip_accum_us;
+
+#if CONFIG_FLAME_MODE_KERNEL_BENCH
+/* Run both kernels over the same config for a few seconds' worth of frames
+ * and log cycles/frame.  Once per boot, on the first flame start. */
+static void flame_kernel_bench(const flame_params_t *p)
+{
+    static bool s_done;
+    if (s_done) return;
+    s_done = true;
+
+    const int frames = FLAME_FPS * 10;
+    const int32_t period = 1000000 / FLAME_FPS;
+    static flame_state_t st;
+    static flame_fire_state_t fst;
+    uint8_t level[LED_COUNT];
+    uint32_t t0, c_float, c_q15;
+
+    flame_kernel_float_reset(&st, 1);
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < frames; i++) flame_kernel_float_step(&st, p, period, level);
+    c_float = esp_cpu_get_cycle_count() - t0;
+
+    flame_kernel_q15_reset(&st, 1);
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < frames; i++) flame_kernel_q15_step(&st, p, period, level);
+    c_q15 = esp_cpu_get_cycle_count() - t0;
+
+    ESP_LOGI(TAG, "kernel bench (%d frames): float %lu cycles/frame, q15 %lu cycles/frame",
+             frames, (unsigned long)(c_float / frames), (unsigned long)(c_q15 / frames));
+
+    uint32_t c_part, c_fire;
+    flame_kernel_q15_reset(&st, 1);
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < frames; i++) flame_kernel_particles_step(&st, p, period, level);
+    c_part = esp_cpu_get_cycle_count() - t0;
+
+    flame_fire_reset(&fst, 1);
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < frames; i++) flame_fire_step(&fst, p, period, level, s_fire_color);
+    c_fire = esp_cpu_get_cycle_count() - t0;
+
+    /* Share of the frame period at the default CPU clock */
+    uint32_t budget = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * (1000000 / FLAME_FPS);
+    ESP_LOGI(TAG, "particle bench (%d embers): %lu cycles/frame, %lu.%02lu%% of frame",
+             CONFIG_FLAME_MODE_PARTICLES, (unsigned long)(c_part / frames),
+             (unsigned long)((uint64_t)c_part * 100 / frames / budget),
+             (unsigned long)((uint64_t)c_part * 10000 / frames / budget % 100));
+    ESP_LOGI(TAG, "fire bench (%d Hz steps): %lu cycles/frame",
+             FLAME_FIRE_HZ, (unsigned long)(c_fire / frames));
+
+    /* Walk noise: previous hardware RNG + Box-Muller path vs anim_rng */
+    const int samples = 4096;
+    volatile float sink = 0.0f;
+    uint32_t c_bm, c_anim;
+
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < samples; i++) {
+        float u1 = (float)(esp_random() >> 8) / (float)(1 << 24);
+        float u2 = (float)(esp_random() >> 8) / (float)(1 << 24);
+        if (u1 < 1e-10f) u1 = 1e-10f;
+        sink += sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
+    }
+    c_bm = esp_cpu_get_cycle_count() - t0;
+
+    anim_rng_t rng;
+    anim_rng_seed(&rng, 1);
+    t0 = esp_cpu_get_cycle_count();
+    for (int i = 0; i < samples; i++) sink += anim_rng_normal(&rng);
+    c_anim = esp_cpu_get_cycle_count() - t0;
+
+    ESP_LOGI(TAG, "rng bench (%d normals): esp_random+Box-Muller %lu cycles, anim_rng %lu cycles",
+             samples, (unsigned long)(c_bm / samples), (unsigned long)(c_anim / samples));
+    flame_kernel_release(&st);
 }
+#endif
 
-/* ── Flame task ── */
+/* ── Baked playback ── */
 
-static void flame_task(void *arg)
+/* Identity of a clip: everything that changes its frames */
+static uint32_t clip_key(const flame_config_t *cfg)
 {
-    /* Flame centre starts at grid centre */
-    float fx = 2.0f;
-    float fy = 2.5f;
-
-    /* Flicker phase */
-    float flicker_phase = 0.0f;
-    float flicker_phase_target = randf_uniform() * 2.0f * M_PI;
-    int   flicker_phase_counter = 0;
-    int   flicker_phase_interval = FLAME_FPS;   /* re-randomise every ~1s */
-
-    int   diag_counter = 0;  /* diagnostic logging counter */
-
-    TickType_t last_wake = xTaskGetTickCount();
-
-    while (s_running) {
-        /* Read current config (may be updated via BLE) */
-        flame_config_t cfg = s_cfg;
-
-        float drift_x     = SCALE_DRIFT(cfg.drift_x);
-        float drift_y     = SCALE_DRIFT(cfg.drift_y);
-        float k_restore   = SCALE_RESTORE(cfg.restore);
-        float sigma_flame = SCALE_RADIUS(cfg.radius);
-        float bias_y      = SCALE_BIAS_Y(cfg.bias_y);
-        float fl_depth    = SCALE_FLICKER_D(cfg.flicker_depth);
-        float fl_speed    = SCALE_FLICKER_S(cfg.flicker_speed);
-        /* Compute pixel values at full range; brightness applied via lamp_set_master
-         * so that gamma correction sees full-range values (avoids dead zone at low brightness) */
-        uint8_t master_out = (uint16_t)s_scene_master * s_master_override / 255;
-
-        /* ── Random walk ── */
-        fx += randf_gaussian(0.0f, drift_x) - k_restore * (fx - 2.0f);
-        fy += randf_gaussian(0.0f, drift_y) - k_restore * (fy - bias_y);
-
-        /* Clamp to populated region */
-        if (fx < 1.0f) fx = 1.0f;
-        if (fx > 3.0f) fx = 3.0f;
-        if (fy < 0.5f) fy = 0.5f;
-        if (fy > 5.5f) fy = 5.5f;
-
-        /* ── Global flicker ── */
-        float t = (float)xTaskGetTickCount() / (float)configTICK_RATE_HZ;
-        float flicker = 1.0f - fl_depth * fabsf(sinf(t * fl_speed * 2.0f * M_PI + flicker_phase));
-
-        /* Re-randomise flicker phase periodically */
-        if (++flicker_phase_counter >= flicker_phase_interval) {
-            flicker_phase_counter = 0;
-            flicker_phase = flicker_phase_target;
-            flicker_phase_target = randf_uniform() * 2.0f * M_PI;
-            /* Next interval: 0.5–2.0 seconds */
-            flicker_phase_interval = FLAME_FPS / 2 + (esp_random() % (FLAME_FPS * 2));
-        }
-        /* Smoothly interpolate toward target phase */
-        flicker_phase += (flicker_phase_target - flicker_phase) * 0.05f;
-
-        /* ── Per-LED intensity ── */
-        float two_sigma_sq = 2.0f * sigma_flame * sigma_flame;
-
-        /* Snapshot colour values (may be updated from another task) */
-        uint8_t cw = s_color_w;
-        uint8_t cn = s_color_n;
-        uint8_t cc = s_color_c;
-
-        for (int i = 0; i < LED_COUNT; i++) {
-            float cx = (float)led_coords[i].col;
-            float cy = (float)led_coords[i].row;
-            float dx = cx - fx;
-            float dy = cy - fy;
-            float d2 = dx * dx + dy * dy;
-
-            /* scale is 0.0–1.0: spatial Gaussian × temporal flicker */
-            float scale = expf(-d2 / two_sigma_sq) * flicker;
-            if (scale < 0.0f) scale = 0.0f;
-            if (scale > 1.0f) scale = 1.0f;
-
-            uint8_t w = (uint8_t)((float)cw * scale);
-            uint8_t n = (uint8_t)((float)cn * scale);
-            uint8_t c = (uint8_t)((float)cc * scale);
-
-            lamp_set_pixel(i, w, n, c);
-        }
+    struct __attribute__((packed)) {
+        uint8_t  params[7];
+        uint8_t  kernel;
+        uint16_t fps;
+        uint32_t frames;
+        uint16_t crossfade;
+        uint64_t seed;
+    } id = {
+        .params    = { cfg->drift_x, cfg->drift_y, cfg->restore, cfg->radius,
+                       cfg->bias_y, cfg->flicker_depth, cfg->flicker_speed },
+        .kernel    = CLIP_KERNEL_ID,
+        .fps       = FLAME_FPS,
+        .frames    = CLIP_FRAMES,
+        .crossfade = CLIP_CROSSFADE,
+        .seed      = CLIP_SEED,
+    };
+    return esp_rom_crc32_le(0, (const uint8_t *)&id, sizeof(id));
+}
 
-        lamp_set_master(master_out);   /* brightness applied after gamma */
-        lamp_flush();
+/* A clip is rendered with its own kernel state */
+typedef struct {
+    flame_params_t p;
+    flame_state_t  st;
+} clip_bake_t;
+
+static void clip_gen(int index, uint8_t level[LED_COUNT], void *arg)
+{
+    clip_bake_t *b = arg;
+    flame_kernel_step(&b->st, &b->p, index ? 1000000 / FLAME_FPS : 0, level);
+}
 
-        /* Periodic diagnostic dump every 5 seconds */
-        if (++diag_counter >= FLAME_FPS * 5) {
-            diag_counter = 0;
-            ESP_LOGI(TAG, "DIAG: color=[%d,%d,%d] master=%d pos=(%.1f,%.1f)",
-                     cw, cn, cc, master_out, fx, fy);
+/* Bakes the latest requested clip unless the partition already holds it.
+ * The kernel steps and flash erase/write take seconds; the flame renders
+ * live meanwhile. */
+static void bake_task(void *arg)
+{
+    static clip_bake_t b;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&s_bake_lock);
+        flame_config_t cfg = s_bake_cfg;
+        uint32_t       key = s_bake_key;
+        bool ok = s_baked && s_baked_key == key;    /* e.g. restarted mid-bake */
+        s_bake_busy = true;
+        taskEXIT_CRITICAL(&s_bake_lock);
+
+        if (!ok) ok = flame_clip_valid(key);
+        if (!ok) {
+            int64_t t0 = esp_timer_get_time();
+            flame_kernel_derive(&cfg, &b.p);
+            flame_kernel_reset(&b.st, CLIP_SEED);
+            esp_err_t ret = flame_clip_bake(key, CLIP_FRAMES, CLIP_CROSSFADE, clip_gen, &b);
+            ok = ret == ESP_OK;
+            flame_kernel_release(&b.st);    /* its atlas is only needed while baking */
+            if (ok) {
+                ESP_LOGI(TAG, "Clip baked in %lld ms", (esp_timer_get_time() - t0) / 1000);
+            } else {
+                ESP_LOGW(TAG, "Clip bake failed (%s) — staying live", esp_err_to_name(ret));
+            }
         }
 
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(FLAME_PERIOD_MS));
+        taskENTER_CRITICAL(&s_bake_lock);
+        s_baked     = ok;
+        s_baked_key = key;
+        s_bake_busy = false;
+        taskEXIT_CRITICAL(&s_bake_lock);
     }
-
-    lamp_off();
-    s_task = NULL;
-    xSemaphoreGive(s_task_done);
-    vTaskDelete(NULL);
 }
 
-/* ── Public API ── */
+/* Queue a bake of the clip for cfg (the newest request wins) */
+static esp_err_t bake_request(const flame_config_t *cfg, uint32_t key)
+{
+    if (!s_bake_task &&
+        xTaskCreatePinnedToCore(bake_task, "flame_bake", BAKE_TASK_STACK, NULL,
+                                BAKE_TASK_PRIO, &s_bake_task, 1) != pdPASS) {
+        s_bake_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    taskENTER_CRITICAL(&s_bake_lock);
+    s_bake_cfg = *cfg;
+    s_bake_key = key;
+    taskEXIT_CRITICAL(&s_bake_lock);
+    xTaskNotifyGive(s_bake_task);
+    return ESP_OK;
+}
 
-esp_err_t flame_mode_start(void)
+/* True once the partition holds the clip for @p key and no bake is running */
+static bool bake_ready(uint32_t key)
 {
-    if (s_running) return ESP_OK;
+    taskENTER_CRITICAL(&s_bake_lock);
+    bool ready = !s_bake_busy && s_baked && s_baked_key == key;
+    taskEXIT_CRITICAL(&s_bake_lock);
+    return ready;
+}
 
-    /* Create the semaphore once (lazy init) */
-    if (!s_task_done) {
-        s_task_done = xSemaphoreCreateBinary();
-        assert(s_task_done);
+/* Map the clip for s_play_key and switch to playback.  Render task, at a
+ * frame boundary. */
+static void clip_switch_in(void)
+{
+    esp_err_t err = flame_clip_open();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Baked clip unavailable (%s) — rendering live", esp_err_to_name(err));
+        return;
     }
+    s_style         = FLAME_STYLE_BAKED;
+    s_clip_accum_us = FLAME_KERNEL_FRAME_US;    /* first frame fetches one */
+    ESP_LOGI(TAG, "Clip ready — playing baked");
+}
 
-    /* If a previous task is still winding down, wait for it */
-    if (s_task != NULL) {
-        ESP_LOGW(TAG, "Waiting for previous flame task to exit");
-        xSemaphoreTake(s_task_done, pdMS_TO_TICKS(500));
+/* The clip holds frames at FLAME_FPS; play them by elapsed time whatever
+ * the render rate — skipping frames above that rate would not help, so the
+ * flame never asks for more than FLAME_FPS while baked */
+static void clip_play(int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    if (dt_us > 0) {
+        s_clip_accum_us += dt_us < FLAME_KERNEL_DT_MAX_US ? dt_us : FLAME_KERNEL_DT_MAX_US;
+    }
+    while (s_clip_accum_us >= FLAME_KERNEL_FRAME_US) {
+        s_clip_accum_us -= FLAME_KERNEL_FRAME_US;
+        flame_clip_next(s_clip_level);
     }
+    memcpy(level, s_clip_level, LED_COUNT);
+}
 
-    /* s_cfg already set via flame_mode_set_config() before start */
-    s_master_override = 255;
+/* False if a config published since start changes the clip — the caller
+ * then drops back to live rendering until the next start */
+static bool play_still_valid(void)
+{
+    uint32_t seq = atomic_load_explicit(&s_params_seq, memory_order_acquire);
+    if (seq == s_play_seq) return true;
+
+    flame_config_t cfg;
+    flame_mode_get_config(&cfg);
+    if (cfg.style != FLAME_STYLE_BAKED || clip_key(&cfg) != s_play_key) return false;
+    s_play_seq = seq;
+    return true;
+}
 
-    ESP_LOGI(TAG, "Starting flame: color=[%d,%d,%d] override=%d scene_master=%d",
-             s_color_w, s_color_n, s_color_c, s_master_override, s_scene_master);
+/* ── Effect callbacks ── */
 
-    s_running = true;
-    BaseType_t ret = xTaskCreatePinnedToCore(flame_task, "flame", FLAME_TASK_STACK,
-                                              NULL, FLAME_TASK_PRIO, &s_task, 0);
-    if (ret != pdPASS) {
-        s_running = false;
-        return ESP_ERR_NO_MEM;
+static const char *style_name(uint8_t style)
+{
+    switch (style) {
+    case FLAME_STYLE_BAKED:     return "baked";
+    case FLAME_STYLE_PARTICLES: return "particles";
+    case FLAME_STYLE_FIRE:      return "fire";
+    default:                    return "live";
     }
+}
 
-    ESP_LOGI(TAG, "Flame mode started (%d fps)", FLAME_FPS);
+/* Highest frame rate worth rendering the current style at: the clip's own
+ * rate, the minimum for a flame that barely moves, else the maximum —
+ * the kernels move the same distance per second at any rate, so a higher
+ * rate only makes motion smoother */
+static uint8_t style_fps(void)
+{
+    if (s_style == FLAME_STYLE_BAKED) return FLAME_FPS;
+    if (s_style == FLAME_STYLE_LIVE && s_anim_params.still) return LAMP_RENDER_FPS_MIN;
+    return LAMP_RENDER_FPS_MAX;
+}
+
+/* Boot: the kernel tables are read by the render and bake tasks alike */
+static esp_err_t flame_init(void)
+{
+    flame_kernel_init();
     return ESP_OK;
 }
 
-void flame_mode_stop(void)
+static void flame_configure(const scene_t *scene)
 {
-    if (!s_running) return;
-    s_running = false;
-    ESP_LOGI(TAG, "Flame mode stopping");
+    flame_config_t cfg = {
+        scene->flame_drift_x, scene->flame_drift_y, scene->flame_restore,
+        scene->flame_radius,  scene->flame_bias_y,  scene->flame_flicker_depth,
+        scene->flame_flicker_speed, scene->flame_style,
+    };
+    flame_mode_set_config(&cfg);
+}
 
-    /* Wait for the task to actually exit before returning */
-    if (s_task != NULL && s_task_done) {
-        xSemaphoreTake(s_task_done, pdMS_TO_TICKS(500));
+static esp_err_t flame_start(void)
+{
+    /* s_cfg normally already set via flame_mode_set_config() before start */
+    if (atomic_load(&s_params_seq) == 0) {
+        flame_config_t cfg;
+        flame_mode_get_config(&cfg);
+        params_publish(&cfg);
+    }
+
+    /* Logged so a session can be replayed with flame_mode_set_seed() */
+    uint64_t seed = s_seed ? s_seed : ((uint64_t)esp_random() << 32) | esp_random();
+
+#if CONFIG_FLAME_MODE_KERNEL_BENCH
+    flame_config_t bench_cfg;
+    flame_params_t bench_params;
+    flame_mode_get_config(&bench_cfg);
+    flame_kernel_derive(&bench_cfg, &bench_params);
+    flame_kernel_bench(&bench_params);
+#endif
+
+    /* Baked style: render live and have the clip for this config checked
+     * (and baked if missing) in the background; the render task switches
+     * to playback once it is in flash.  No partition or a failed bake
+     * leaves the flame live. */
+    s_play_seq = atomic_load_explicit(&s_params_seq, memory_order_acquire);
+    flame_config_t cfg;
+    flame_mode_get_config(&cfg);
+    s_style = cfg.style == FLAME_STYLE_PARTICLES || cfg.style == FLAME_STYLE_FIRE
+            ? cfg.style : FLAME_STYLE_LIVE;
+    s_play_wait = false;
+    if (cfg.style == FLAME_STYLE_BAKED) {
+        s_play_key  = clip_key(&cfg);
+        s_play_seed = seed;
+        esp_err_t err = bake_request(&cfg, s_play_key);
+        if (err == ESP_OK) {
+            s_play_wait = true;
+        } else {
+            ESP_LOGW(TAG, "Clip bake not started (%s) — rendering live", esp_err_to_name(err));
+        }
     }
+
+    /* The particle step runs on the q15 kernel state whichever kernel is
+     * built as the default */
+    if (s_style == FLAME_STYLE_PARTICLES) flame_kernel_q15_reset(&s_state, seed);
+    else if (s_style == FLAME_STYLE_FIRE) flame_fire_reset(&s_fire_state, seed);
+    else flame_kernel_reset(&s_state, seed);
+    s_last_t_us     = 0;
+    s_clip_accum_us = FLAME_KERNEL_FRAME_US;    /* first frame fetches one */
+    s_diag_us       = 0;
+    ESP_LOGI(TAG, "Flame start: %s, seed=0x%016llx", style_name(s_style),
+             (unsigned long long)seed);
+    return ESP_OK;
 }
 
-esp_err_t flame_mode_set_config(const flame_config_t *cfg)
+/* One frame, run by the render task at the rate it picks (≤ style_fps) */
+static bool flame_render(int64_t t_us, uint8_t *level, int count)
 {
-    ESP_LOGI(TAG, "set_config: dx=%d dy=%d rst=%d r=%d by=%d fd=%d fs=%d",
-             cfg->drift_x, cfg->drift_y, cfg->restore, cfg->radius,
-             cfg->bias_y, cfg->flicker_depth, cfg->flicker_speed);
-    s_cfg = *cfg;
-    return ESP_OK;
+    int32_t dt_us = (int32_t)(t_us - s_last_t_us);
+    s_last_t_us = t_us;
+
+    if (s_style == FLAME_STYLE_BAKED && !play_still_valid()) {
+        ESP_LOGI(TAG, "Config changed — live rendering until next start");
+        flame_clip_close();
+        flame_kernel_reset(&s_state, s_play_seed);
+        s_style = FLAME_STYLE_LIVE;
+    } else if (s_play_wait) {
+        if (!play_still_valid()) {
+            s_play_wait = false;
+        } else if (bake_ready(s_play_key)) {
+            s_play_wait = false;
+            clip_switch_in();
+        }
+    }
+
+    /* Intensity map at full range; the compositor multiplies it with the
+     * base colour before gamma and applies master/fade after it (avoids a
+     * dead zone at low brightness) */
+    if (s_style == FLAME_STYLE_BAKED) {
+        clip_play(dt_us, level);
+    } else {
+        /* Pick up a config published via BLE since the last frame */
+        params_update();
+        if (s_style == FLAME_STYLE_PARTICLES) {
+            flame_kernel_particles_step(&s_state, &s_anim_params, dt_us, level);
+        } else if (s_style == FLAME_STYLE_FIRE) {
+            /* The palette replaces the scene colour in the base layer */
+            flame_fire_step(&s_fire_state, &s_anim_params, dt_us, level, s_fire_color);
+            lamp_set_pixels(s_fire_color);
+        } else {
+            flame_kernel_step(&s_state, &s_anim_params, dt_us, level);
+        }
+    }
+    lamp_effect_set_fps(style_fps());
+
+    /* Periodic diagnostic dump every 5 seconds */
+    s_diag_us += dt_us;
+    if (s_diag_us >= 5000000) {
+        s_diag_us = 0;
+        led_driver_stats_t st;
+        led_driver_get_stats(&st);
+        float fx, fy;
+        if (s_style == FLAME_STYLE_PARTICLES) flame_kernel_q15_pos(&s_state, &fx, &fy);
+        else flame_kernel_pos(&s_state, &fx, &fy);
+        ESP_LOGI(TAG, "DIAG: %s %ufps master=%d fade=%d pos=(%.1f,%.1f) frames=%lu dropped=%lu skipped=%lu",
+                 style_name(s_style), lamp_render_get_fps(), lamp_get_master(), lamp_get_fade(), fx, fy,
+                 (unsigned long)st.frames, (unsigned long)st.dropped,
+                 (unsigned long)st.skipped);
+    }
+
+    return true;
 }
 
-void flame_mode_get_config(flame_config_t *cfg)
+static void flame_stop(void)
 {
-    *cfg = s_cfg;
+    /* A bake in progress carries on; the next start picks up its result */
+    flame_clip_close();
+    s_style     = FLAME_STYLE_LIVE;
+    s_play_wait = false;
 }
 
-void flame_mode_set_color(uint8_t warm, uint8_t neutral, uint8_t cool)
+const lamp_effect_t flame_effect = {
+    .id        = EFFECT_ID_FLAME,
+    .name      = "flame",
+    .init      = flame_init,
+    .configure = flame_configure,
+    .start     = flame_start,
+    .render    = flame_render,
+    .stop      = flame_stop,
+};
+
+/* ── Public API ── */
+
+esp_err_t flame_mode_register(void)
 {
-    s_color_w = warm;
-    s_color_n = neutral;
-    s_color_c = cool;
-    ESP_LOGI(TAG, "set_color: [%d,%d,%d]", warm, neutral, cool);
+    return lamp_effect_register(&flame_effect);
 }
 
-bool flame_mode_is_active(void)
+esp_err_t flame_mode_set_config(const flame_config_t *cfg)
 {
-    return s_running;
+    ESP_LOGI(TAG, "set_config: dx=%d dy=%d rst=%d r=%d by=%d fd=%d fs=%d style=%d",
+             cfg->drift_x, cfg->drift_y, cfg->restore, cfg->radius,
+             cfg->bias_y, cfg->flicker_depth, cfg->flicker_speed, cfg->style);
+    params_publish(cfg);
+    return ESP_OK;
 }
 
-void flame_mode_set_master_override(uint8_t master)
+void flame_mode_get_config(flame_config_t *cfg)
 {
-    ESP_LOGI(TAG, "master_override: %d", master);
-    s_master_override = master;
+    taskENTER_CRITICAL(&s_cfg_lock);
+    *cfg = s_cfg;
+    taskEXIT_CRITICAL(&s_cfg_lock);
 }
 
-void flame_mode_set_scene_master(uint8_t master)
+void flame_mode_set_seed(uint64_t seed)
 {
-    ESP_LOGI(TAG, "scene_master: %d", master);
-    s_scene_master = master;
+    s_seed = seed;
 }
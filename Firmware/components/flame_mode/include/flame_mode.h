@@ -2,24 +2,29 @@
 
 #include "esp_err.h"
 #include "lamp_nvs.h"
+#include "lamp_effect.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * Start the flame animation task (30 fps).
- * Loads config from NVS on start.
+ * Candle flame effect (EFFECT_ID_FLAME), run by the lamp_effects engine.
+ * Intensity comes from the flame kernel each frame, from a baked clip in
+ * flash with FLAME_STYLE_BAKED, or from the kernel plus a small pool of
+ * rising embers with FLAME_STYLE_PARTICLES.
  */
-esp_err_t flame_mode_start(void);
+extern const lamp_effect_t flame_effect;
 
 /**
- * Stop the flame animation task and turn off LEDs.
+ * Register flame_effect with the effect engine.  Call before
+ * lamp_effect_init().
  */
-void flame_mode_stop(void);
+esp_err_t flame_mode_register(void);
 
 /**
- * Update flame parameters at runtime (also saves to NVS).
+ * Update flame parameters at runtime.  Takes effect on the next frame
+ * (a change of style on the next start).
  */
 esp_err_t flame_mode_set_config(const flame_config_t *cfg);
 
@@ -29,29 +34,12 @@ esp_err_t flame_mode_set_config(const flame_config_t *cfg);
 void flame_mode_get_config(flame_config_t *cfg);
 
 /**
- * Set the base colour for the flame effect.
- * The flame animation modulates intensity while keeping this colour ratio
- * constant across all pixels.  Call this when the active scene changes.
+ * Fix the noise seed used by the next flame start (0 = pick a new random
+ * seed on every start, the default).  With a fixed seed and config the
+ * flame replays the same frame sequence; the seed in use is logged on
+ * start.
  */
-void flame_mode_set_color(uint8_t warm, uint8_t neutral, uint8_t cool);
-
-/**
- * Returns true if the flame task is currently running.
- */
-bool flame_mode_is_active(void);
-
-/**
- * Set a master brightness override (0–255).
- * Used by auto mode to dim the flame effect.  Resets to 255 on start.
- */
-void flame_mode_set_master_override(uint8_t master);
-
-/**
- * Set the scene master brightness (0–255).
- * This is the global brightness from scene.master, replacing the old
- * per-flame-config brightness.  Call when global brightness changes.
- */
-void flame_mode_set_scene_master(uint8_t master);
+void flame_mode_set_seed(uint64_t seed);
 
 #ifdef __cplusplus
 }
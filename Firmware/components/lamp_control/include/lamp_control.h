@@ -28,20 +28,39 @@ uint8_t lamp_control_get_flags(void);
 uint8_t lamp_control_get_master(void);
 
 /**
- * Set mode flags bitmask.  Independently starts/stops auto and flame.
+ * Get the effect run in effect mode (EFFECT_ID_*).
+ */
+uint8_t lamp_control_get_effect(void);
+
+/**
+ * Select the effect run in effect mode (persists to active scene in NVS).
+ * Switches immediately if an effect is showing.
+ * @return ESP_ERR_INVALID_ARG if @p effect_id is not registered.
+ */
+esp_err_t lamp_control_set_effect(uint8_t effect_id);
+
+/**
+ * Set mode flags bitmask.  Independently starts/stops auto and the effect
+ * (MODE_FLAG_FLAME).
  */
 void lamp_control_set_flags(uint8_t flags);
 
+/* lamp_control_apply_scene() transition: the scene's own fade_in_s */
+#define LAMP_TRANSITION_SCENE   UINT32_MAX
+
 /**
- * Apply a scene immediately (used from BLE writes and NVS restore).
- * Atomically sets all sub-module configs (auto, flame, PIR) and applies LEDs.
+ * Apply a scene (used for group sync).
+ * Atomically sets all sub-module configs (auto, effects, PIR) and crossfades
+ * the LEDs from what is showing to the scene's colour and master.
+ * @param transition_ms  Crossfade length; 0 snaps, LAMP_TRANSITION_SCENE
+ *                       uses scene->fade_in_s.
  */
-void lamp_control_apply_scene(const scene_t *scene);
+void lamp_control_apply_scene(const scene_t *scene, uint32_t transition_ms);
 
 /**
  * Update LED state (warm/neutral/cool/master) in a mode-aware way.
  * In manual mode: applies directly to framebuffer.
- * In flame mode:  updates colour ratios without interrupting animation.
+ * In effect mode: updates colour ratios without interrupting animation.
  * In auto mode:   saves state for next ON transition.
  */
 void lamp_control_set_state(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t master);
@@ -1,12 +1,18 @@
 #include "lamp_control.h"
 #include "led_driver.h"
+#include "lamp_render.h"
+#include "lamp_fade.h"
 #include "sensor.h"
 #include "lamp_nvs.h"
 #include "auto_mode.h"
 #include "flame_mode.h"
+#include "lamp_effect.h"
 #include "circadian_mode.h"
 #include "esp_now_sync.h"
+#include "lamp_timer.h"
 #include "esp_log.h"
+#include <stdatomic.h>
+#include <stdint.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -23,81 +29,180 @@ static const char *TAG = "lamp_ctrl";
 #define CTRL_TASK_STACK     4096
 #define CTRL_TASK_PRIO      5
 
+/* Explicit on/off (touch, app) fades over SWITCH_FADE_MS; slider moves apply
+ * at once so they track the finger.  Peers see a change up to ~1 s late and
+ * at slightly different moments, so what we broadcast they crossfade over
+ * at least SYNC_FADE_MS. */
+#define SWITCH_FADE_MS      400
+#define SYNC_FADE_MS        500
+
 static uint8_t          s_flags = 0;   /* bitmask: MODE_FLAG_AUTO | MODE_FLAG_FLAME */
 static bool             s_lamp_on = true;
 static bool             s_from_sync = false;  /* suppresses re-broadcast when true */
 static uint8_t          s_configured_master = 128;  /* last non-zero master; used in broadcasts when lamp is off */
 static QueueHandle_t    s_sensor_queue;
+static volatile bool    s_timer_wake_pending;  /* a SENSOR_EVT_TIMER is already queued */
 static scene_t          s_active_scene;
 
+/* switch_off() fades carry s_switch_seq as their done argument; raising
+ * the envelope again moves it on, so a switch-off that landed (on the
+ * render task) just before is not acted on by the control task */
+static uint32_t         s_switch_seq = 1;
+static _Atomic uint32_t s_switch_done_seq;  /* landed, not yet handled; 0 = none */
+
 /* Forward declaration — defined after helpers */
-static void broadcast_current_state(void);
+static void broadcast_current_state(uint32_t transition_ms);
 
 /* ── Auto mode transition callback ── */
 
-static void auto_transition_handler(auto_transition_t transition, uint8_t dim_master)
+static void auto_transition_handler(auto_transition_t transition, uint8_t level)
 {
     switch (transition) {
     case AUTO_TRANSITION_ON:
         s_lamp_on = true;
+        s_switch_seq++;
         if (s_flags & MODE_FLAG_FLAME) {
-            flame_mode_set_color(s_active_scene.warm, s_active_scene.neutral,
-                                 s_active_scene.cool);
-            if (!flame_mode_is_active()) {
-                flame_mode_start();
+            lamp_effect_set_color(s_active_scene.warm, s_active_scene.neutral,
+                                  s_active_scene.cool);
+            if (!lamp_effect_is_active()) {
+                lamp_effect_start(s_active_scene.effect_id);
             }
-            /* dim_master=0 at fade-in start, full value when fade completes or instant */
-            flame_mode_set_master_override(dim_master);
         } else {
             lamp_fill(s_active_scene.warm, s_active_scene.neutral, s_active_scene.cool);
-            lamp_set_master(dim_master);
-            lamp_flush();
+            lamp_set_master(s_active_scene.master);
         }
-        /* Broadcast to group when lamp is fully on (not during the prep call with dim=0) */
-        if (dim_master > 0) {
-            broadcast_current_state();
-        }
-        break;
-
-    case AUTO_TRANSITION_DIMMING:
-        if (s_flags & MODE_FLAG_FLAME) {
-            flame_mode_set_master_override(dim_master);
-        } else {
-            lamp_set_master(dim_master);
-            lamp_flush();
+        /* level=0 at fade-in start, AUTO_FADE_FULL when fade completes or instant */
+        lamp_set_fade(level);
+        lamp_flush();
+        /* Broadcast to group when lamp is fully on (not during the prep call with level=0) */
+        if (level > 0) {
+            broadcast_current_state(0);
         }
         break;
 
     case AUTO_TRANSITION_OFF:
         s_lamp_on = false;
         if (s_flags & MODE_FLAG_FLAME) {
-            flame_mode_stop();
+            lamp_effect_stop();
         }
         lamp_off();
-        broadcast_current_state();
+        broadcast_current_state(0);
         break;
     }
 }
 
-/* ── Helpers ── */
+/* ── Pairing blink (compositor overlay layer) ── */
+
+#define PAIR_BLINK_COUNT        3
+#define PAIR_BLINK_PERIOD_US    300000
+#define PAIR_BLINK_ALPHA        160
+
+static int64_t s_pair_blink_start_us;   /* 0 = take the first tick as start */
 
-static void apply_manual_scene(void)
+static bool pair_blink_animate(int64_t now_us, void *arg)
 {
-    lamp_fill(s_active_scene.warm, s_active_scene.neutral, s_active_scene.cool);
-    lamp_set_master(s_active_scene.master);
+    if (s_pair_blink_start_us == 0) s_pair_blink_start_us = now_us;
+    int64_t elapsed = now_us - s_pair_blink_start_us;
+
+    if (elapsed >= (int64_t)PAIR_BLINK_COUNT * PAIR_BLINK_PERIOD_US) {
+        lamp_set_overlay(0, 0, 0, 0);
+        lamp_flush();
+        return false;
+    }
+    /* Cool-white blink on top of whatever is showing, even when off */
+    bool on = (elapsed % PAIR_BLINK_PERIOD_US) < PAIR_BLINK_PERIOD_US / 2;
+    lamp_set_overlay(0, 0, 255, on ? PAIR_BLINK_ALPHA : 0);
     lamp_flush();
+    return true;
+}
+
+/* ── Helpers ── */
+
+/* Move to the active scene's colour and master at full envelope.  From dark
+ * the colour is set straight away and only the envelope rises, so colour
+ * and brightness do not ramp on top of each other. */
+static void apply_manual_scene(uint32_t fade_ms)
+{
+    const lamp_fade_level_t to = {
+        .warm     = s_active_scene.warm,
+        .neutral  = s_active_scene.neutral,
+        .cool     = s_active_scene.cool,
+        .master   = s_active_scene.master,
+        .envelope = AUTO_FADE_FULL,
+    };
+    uint8_t channels = LAMP_FADE_COLOR | LAMP_FADE_MASTER | LAMP_FADE_ENVELOPE;
+
+    s_switch_seq++;
+    if (fade_ms > 0 && lamp_get_fade() == 0) {
+        lamp_fill(to.warm, to.neutral, to.cool);
+        lamp_set_master(to.master);
+        channels = LAMP_FADE_ENVELOPE;
+    }
+    lamp_fade_to(&to, channels, fade_ms, LAMP_EASE_IN_OUT, NULL, NULL);
+}
+
+/* Fade end of switch_off(), with the envelope at 0 — runs on the render
+ * task (or the caller for a zero-length fade): the control task blanks.  A
+ * full queue loses only the wake-up — the next event runs it. */
+static void switch_off_landed(void *arg)
+{
+    atomic_store(&s_switch_done_seq, (uint32_t)(uintptr_t)arg);
+    sensor_event_t evt = { .type = SENSOR_EVT_FADE_DONE };
+    xQueueSend(s_sensor_queue, &evt, 0);
+}
+
+/* Control task: stop the effect (if any) and blank once a switch-off has
+ * landed, unless the lamp has been switched back on since */
+static void switch_off_done(void)
+{
+    uint32_t seq = atomic_exchange(&s_switch_done_seq, 0);
+    if (seq != s_switch_seq) return;
+    lamp_effect_stop();
+    lamp_off();
+}
+
+/* Fade the envelope out, then stop the effect (if any) and blank */
+static void switch_off(uint32_t fade_ms)
+{
+    const lamp_fade_level_t to = { .envelope = 0 };
+    if (lamp_get_fade() == 0) fade_ms = 0;      /* already dark */
+    lamp_fade_to(&to, LAMP_FADE_ENVELOPE, fade_ms, LAMP_EASE_IN_OUT,
+                 switch_off_landed, (void *)(uintptr_t)s_switch_seq);
+}
+
+/* Bring the envelope back up over whatever the base/effect layers hold */
+static void switch_on(uint32_t fade_ms)
+{
+    const lamp_fade_level_t to = { .envelope = AUTO_FADE_FULL };
+    s_switch_seq++;
+    lamp_fade_to(&to, LAMP_FADE_ENVELOPE, fade_ms, LAMP_EASE_IN_OUT, NULL, NULL);
+}
+
+/* Effect modes: restart the effect from dark if switch_off() stopped it, and
+ * bring it up — also reverses a switch-off still in progress */
+static void switch_on_effect(uint32_t fade_ms)
+{
+    if (!lamp_effect_is_active()) {
+        lamp_set_fade(0);
+        lamp_effect_start(s_active_scene.effect_id);
+    }
+    if (lamp_fade_is_running(LAMP_FADE_ENVELOPE) || lamp_get_fade() < AUTO_FADE_FULL) {
+        switch_on(fade_ms);
+    }
 }
 
-/* Broadcast the current full scene + lamp_on state to group peers.
+/* Broadcast the current full scene + lamp_on state to group peers, to be
+ * reached over @p transition_ms (at least SYNC_FADE_MS).
  * Suppressed when s_from_sync is set (prevents re-broadcast loops).
  * Always sends s_configured_master (last non-zero master) so peers never
  * receive master=0 as the scene target — lamp_on carries the on/off state. */
-static void broadcast_current_state(void)
+static void broadcast_current_state(uint32_t transition_ms)
 {
     if (s_from_sync) return;
     scene_t bc = s_active_scene;
     if (bc.master == 0) bc.master = s_configured_master;
-    esp_now_sync_broadcast(&bc, s_lamp_on);
+    if (transition_ms < SYNC_FADE_MS) transition_ms = SYNC_FADE_MS;
+    esp_now_sync_broadcast(&bc, s_lamp_on, transition_ms);
 }
 
 /* ── Public API ── */
@@ -112,6 +217,28 @@ uint8_t lamp_control_get_master(void)
     return s_active_scene.master;
 }
 
+uint8_t lamp_control_get_effect(void)
+{
+    return s_active_scene.effect_id;
+}
+
+esp_err_t lamp_control_set_effect(uint8_t effect_id)
+{
+    if (!lamp_effect_find(effect_id)) return ESP_ERR_INVALID_ARG;
+    if (effect_id == s_active_scene.effect_id) return ESP_OK;
+
+    ESP_LOGI(TAG, "Effect change: %u → %u", s_active_scene.effect_id, effect_id);
+    s_active_scene.effect_id = effect_id;
+    lamp_nvs_save_active_scene(&s_active_scene);
+
+    /* Switch over without blanking if an effect is showing */
+    if (lamp_effect_is_active()) {
+        lamp_effect_start(effect_id);
+    }
+    broadcast_current_state(0);
+    return ESP_OK;
+}
+
 void lamp_control_set_flags(uint8_t flags)
 {
     flags &= MODE_FLAGS_MASK;
@@ -134,9 +261,10 @@ void lamp_control_set_flags(uint8_t flags)
     /* Stop what was running and is no longer needed */
     if (old_auto && !new_auto) {
         auto_mode_disable();
+        lamp_set_fade(AUTO_FADE_FULL);
     }
     if (old_flame && !new_flame) {
-        flame_mode_stop();
+        lamp_effect_stop();
     }
     if (old_circ && !new_circ) {
         circadian_mode_disable();
@@ -147,10 +275,11 @@ void lamp_control_set_flags(uint8_t flags)
         auto_mode_enable();
     }
     if (new_flame && !old_flame) {
-        flame_mode_set_color(s_active_scene.warm, s_active_scene.neutral,
-                             s_active_scene.cool);
-        flame_mode_set_scene_master(s_active_scene.master);
-        flame_mode_start();
+        lamp_effect_set_color(s_active_scene.warm, s_active_scene.neutral,
+                              s_active_scene.cool);
+        lamp_effect_set_scene_master(s_active_scene.master);
+        lamp_set_fade(AUTO_FADE_FULL);
+        lamp_effect_start(s_active_scene.effect_id);
     }
     if (new_circ && !old_circ) {
         circadian_mode_enable();
@@ -158,14 +287,17 @@ void lamp_control_set_flags(uint8_t flags)
 
     /* If neither flag: restore manual static scene (only if lamp is on) */
     if (flags == 0 && s_lamp_on) {
-        apply_manual_scene();
+        apply_manual_scene(0);
     }
 
-    broadcast_current_state();
+    broadcast_current_state(0);
 }
 
-void lamp_control_apply_scene(const scene_t *scene)
+void lamp_control_apply_scene(const scene_t *scene, uint32_t transition_ms)
 {
+    if (transition_ms == LAMP_TRANSITION_SCENE) {
+        transition_ms = (uint32_t)scene->fade_in_s * 1000;
+    }
     s_active_scene = *scene;
     lamp_nvs_save_active_scene(scene);
 
@@ -175,12 +307,7 @@ void lamp_control_apply_scene(const scene_t *scene)
     auto_mode_set_config(&ac);
     auto_mode_set_fade_rates(scene->fade_in_s, scene->fade_out_s);
 
-    flame_config_t fc = {
-        scene->flame_drift_x, scene->flame_drift_y, scene->flame_restore,
-        scene->flame_radius,  scene->flame_bias_y,  scene->flame_flicker_depth,
-        scene->flame_flicker_speed,
-    };
-    flame_mode_set_config(&fc);
+    lamp_effect_configure(scene);
 
     sensor_set_pir_sensitivity(scene->pir_sensitivity);
 
@@ -193,16 +320,30 @@ void lamp_control_apply_scene(const scene_t *scene)
                                   scene->cool, scene->master);
 
     if (s_flags & MODE_FLAG_FLAME) {
-        flame_mode_set_color(scene->warm, scene->neutral, scene->cool);
-        flame_mode_set_scene_master(scene->master);
+        /* Glides under the running effect (stored if none is running) */
+        lamp_effect_fade_to(scene->warm, scene->neutral, scene->cool, scene->master,
+                            transition_ms);
+        /* Switches effect if the scene selects a different one */
+        if (lamp_effect_is_active()) {
+            lamp_effect_start(scene->effect_id);
+        }
+    } else if ((s_flags & MODE_FLAG_AUTO) && auto_mode_get_state() != AUTO_STATE_IDLE) {
+        /* Auto is showing the scene: crossfade colour and master underneath
+         * its envelope fade, which keeps running */
+        const lamp_fade_level_t to = {
+            .warm = scene->warm, .neutral = scene->neutral, .cool = scene->cool,
+            .master = scene->master,
+        };
+        lamp_fade_to(&to, LAMP_FADE_COLOR | LAMP_FADE_MASTER, transition_ms,
+                     LAMP_EASE_IN_OUT, NULL, NULL);
     }
 
     if (s_flags == 0 && s_lamp_on) {
-        /* Pure manual: apply directly (skip if lamp is off — avoids a brief
+        /* Pure manual: crossfade (skip if lamp is off — avoids a brief
          * flash when called from apply_sync with lamp_on=0) */
-        apply_manual_scene();
+        apply_manual_scene(transition_ms);
     }
-    /* If auto-only or auto+flame: scene stored for next auto ON transition */
+    /* Auto while idle: scene stored for the next auto ON transition */
 }
 
 void lamp_control_set_state(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t master)
@@ -216,40 +357,50 @@ void lamp_control_set_state(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t
 
     ESP_LOGI(TAG, "set_state: [%d,%d,%d,%d] flags=0x%02x", warm, neutral, cool, master, s_flags);
 
+    /* On/off switches fade; changes while on are slider moves and snap */
+    bool was_on = s_lamp_on;
+
     if (s_flags & MODE_FLAG_FLAME) {
-        flame_mode_set_color(warm, neutral, cool);
+        lamp_effect_set_color(warm, neutral, cool);
         if (master == 0) {
-            /* App on/off: stop flame and turn off LEDs */
-            flame_mode_stop();
-            lamp_off();
+            /* App on/off: fade out, then stop the effect and turn off LEDs */
+            switch_off(SWITCH_FADE_MS);
             s_lamp_on = false;
         } else {
-            flame_mode_set_scene_master(master);
-            if (!flame_mode_is_active()) {
-                /* Turning back on: restart flame */
-                flame_mode_start();
-            }
+            lamp_effect_set_scene_master(master);
+            switch_on_effect(SWITCH_FADE_MS);
             s_lamp_on = true;
         }
     } else if (s_flags & MODE_FLAG_AUTO) {
         /* Keep auto_mode's internal scene in sync so fades target the right values.
-         * This also aborts any in-progress fade-out if master > 0. */
+         * This also turns an in-progress fade-out back up if master > 0. */
         auto_mode_notify_scene_change(warm, neutral, cool, master);
         /* Auto-only mode: honour explicit on/off; apply colours when lamp is on */
         if (master == 0) {
-            lamp_off();
+            auto_mode_cancel();
+            switch_off(SWITCH_FADE_MS);
             s_lamp_on = false;
+        } else if (auto_mode_get_state() == AUTO_STATE_FADING_IN) {
+            /* Auto's fade owns the envelope — just repaint underneath it */
+            lamp_fill(warm, neutral, cool);
+            lamp_set_master(master);
+            lamp_flush();
+            s_lamp_on = true;
         } else {
-            apply_manual_scene();
+            apply_manual_scene(was_on ? 0 : SWITCH_FADE_MS);
             s_lamp_on = true;
         }
     } else {
         /* Manual mode: apply directly */
         s_lamp_on = (master > 0);
-        apply_manual_scene();
+        if (master == 0) {
+            switch_off(SWITCH_FADE_MS);
+        } else {
+            apply_manual_scene(was_on ? 0 : SWITCH_FADE_MS);
+        }
     }
 
-    broadcast_current_state();
+    broadcast_current_state(s_lamp_on != was_on ? SWITCH_FADE_MS : 0);
 }
 
 void lamp_control_apply_sync(const sensor_sync_data_t *sync)
@@ -290,6 +441,8 @@ void lamp_control_apply_sync(const sensor_sync_data_t *sync)
     scene.flame_bias_y       = sync->flame_config[4];
     scene.flame_flicker_depth  = sync->flame_config[5];
     scene.flame_flicker_speed  = sync->flame_config[6];
+    scene.flame_style        = sync->flame_style;
+    scene.effect_id          = sync->effect_id;
     scene.pir_sensitivity    = sync->pir_sensitivity;
 
     /* Set lamp_on state BEFORE apply_scene so that apply_scene's LED write
@@ -301,7 +454,7 @@ void lamp_control_apply_sync(const sensor_sync_data_t *sync)
     s_configured_master = sync->master;
 
     s_from_sync = true;
-    lamp_control_apply_scene(&scene);
+    lamp_control_apply_scene(&scene, sync->transition_ms);
     /* apply_scene() calls auto_mode_notify_scene_change() internally — fade
      * targets are now up to date. Handle operational on/off separately. */
     if (s_flags & MODE_FLAG_AUTO) {
@@ -312,9 +465,14 @@ void lamp_control_apply_sync(const sensor_sync_data_t *sync)
         }
     }
     /* For manual/flame modes, apply_scene() already wrote the LEDs.
-     * If the peer's lamp is off (lamp_on=0) in manual mode, turn off locally too. */
-    if (!(s_flags & MODE_FLAG_AUTO) && !sync->lamp_on) {
-        lamp_off();
+     * If the peer's lamp is off (lamp_on=0) in manual mode, turn off locally too.
+     * Retries of the same packet re-issue the same fade, which keeps running. */
+    if (!(s_flags & MODE_FLAG_AUTO)) {
+        if (!sync->lamp_on) {
+            switch_off(sync->transition_ms);
+        } else if (s_flags & MODE_FLAG_FLAME) {
+            switch_on_effect(sync->transition_ms);
+        }
     }
     s_from_sync = false;
 }
@@ -326,7 +484,7 @@ void lamp_control_update_auto_config(const auto_config_t *cfg)
     s_active_scene.auto_lux_threshold = cfg->lux_threshold;
     s_active_scene.auto_suppress_min  = cfg->suppress_min;
     lamp_nvs_save_active_scene(&s_active_scene);
-    broadcast_current_state();
+    broadcast_current_state(0);
 }
 
 void lamp_control_update_flame_config(const flame_config_t *cfg)
@@ -339,8 +497,9 @@ void lamp_control_update_flame_config(const flame_config_t *cfg)
     s_active_scene.flame_bias_y        = cfg->bias_y;
     s_active_scene.flame_flicker_depth = cfg->flicker_depth;
     s_active_scene.flame_flicker_speed = cfg->flicker_speed;
+    s_active_scene.flame_style         = cfg->style;
     lamp_nvs_save_active_scene(&s_active_scene);
-    broadcast_current_state();
+    broadcast_current_state(0);
 }
 
 void lamp_control_set_pir_sensitivity(uint8_t level)
@@ -348,18 +507,45 @@ void lamp_control_set_pir_sensitivity(uint8_t level)
     sensor_set_pir_sensitivity(level);
     s_active_scene.pir_sensitivity = level;
     lamp_nvs_save_active_scene(&s_active_scene);
-    broadcast_current_state();
+    broadcast_current_state(0);
 }
 
 /* ── Event loop task ── */
 
+/* lamp_timer wake hook (esp_timer task): one queued wake-up is enough, since
+ * the loop runs every due timer each time round */
+static void control_timer_wake(void)
+{
+    if (s_timer_wake_pending) return;
+    s_timer_wake_pending = true;
+    sensor_event_t evt = { .type = SENSOR_EVT_TIMER };
+    if (xQueueSend(s_sensor_queue, &evt, 0) != pdTRUE) {
+        s_timer_wake_pending = false;   /* queue full: the next event runs them */
+    }
+}
+
 static void control_task(void *arg)
 {
     sensor_event_t evt;
 
     for (;;) {
+        /* Module timers (touch poll, light sampling, auto and circadian)
+         * and fade completions run here, between events, so none of them
+         * races the handlers.  A parked touch pin that fired resumes
+         * polling first. */
+        s_timer_wake_pending = false;
+        sensor_touch_wake();
+        lamp_timer_run();
+        switch_off_done();
+        auto_mode_fade_done();
+
         if (xQueueReceive(s_sensor_queue, &evt, portMAX_DELAY) == pdTRUE) {
             switch (evt.type) {
+            case SENSOR_EVT_TIMER:
+            case SENSOR_EVT_TOUCH_WAKE:
+            case SENSOR_EVT_FADE_DONE:
+                break;
+
             case SENSOR_EVT_TOUCH_SHORT:
                 ESP_LOGI(TAG, "Touch: short tap (on=%d, flags=0x%02x suppressed=%d)",
                          s_lamp_on, s_flags, auto_mode_is_suppressed());
@@ -392,11 +578,13 @@ static void control_task(void *arg)
             case SENSOR_EVT_TOUCH_LONG:
                 ESP_LOGI(TAG, "Touch: long press → start advertising");
                 ble_start_advertising();
+                s_pair_blink_start_us = 0;
+                lamp_animator_start(pair_blink_animate, NULL);
                 break;
 
             case SENSOR_EVT_SYNC:
                 ESP_LOGI(TAG, "Sync RX: [%d,%d,%d,%d] flags=0x%02x lamp_on=%d"
-                         " auto=[%u,%u] pir=%d flame=[%d,%d,%d,%d,%d,%d,%d]",
+                         " auto=[%u,%u] pir=%d flame=[%d,%d,%d,%d,%d,%d,%d,%d] effect=%d",
                          evt.data.sync.warm, evt.data.sync.neutral,
                          evt.data.sync.cool, evt.data.sync.master,
                          evt.data.sync.flags, evt.data.sync.lamp_on,
@@ -409,7 +597,9 @@ static void control_task(void *arg)
                          evt.data.sync.flame_config[3],
                          evt.data.sync.flame_config[4],
                          evt.data.sync.flame_config[5],
-                         evt.data.sync.flame_config[6]);
+                         evt.data.sync.flame_config[6],
+                         evt.data.sync.flame_style,
+                         evt.data.sync.effect_id);
                 lamp_control_apply_sync(&evt.data.sync);
                 break;
 
@@ -452,20 +642,17 @@ esp_err_t lamp_control_init(QueueHandle_t sensor_queue)
     sensor_set_pir_sensitivity(s_active_scene.pir_sensitivity);
 
     auto_config_t ac = { s_active_scene.auto_timeout_s, s_active_scene.auto_lux_threshold };
-    flame_config_t fc = {
-        s_active_scene.flame_drift_x, s_active_scene.flame_drift_y,
-        s_active_scene.flame_restore,  s_active_scene.flame_radius,
-        s_active_scene.flame_bias_y,   s_active_scene.flame_flicker_depth,
-        s_active_scene.flame_flicker_speed,
-    };
 
     /* Initialise sub-modules */
-    auto_mode_init();
+    auto_mode_init(sensor_queue);
     auto_mode_set_transition_cb(auto_transition_handler);
     auto_mode_set_config(&ac);
     auto_mode_set_fade_rates(s_active_scene.fade_in_s, s_active_scene.fade_out_s);
-    flame_mode_set_config(&fc);
+    flame_mode_register();
+    lamp_effect_init();
+    lamp_effect_configure(&s_active_scene);
     circadian_mode_init();
+    lamp_timer_set_wake(control_timer_wake);
 
     /* Apply saved flags */
     s_lamp_on = true;
@@ -473,16 +660,16 @@ esp_err_t lamp_control_init(QueueHandle_t sensor_queue)
         auto_mode_enable();
     }
     if (s_flags & MODE_FLAG_FLAME) {
-        flame_mode_set_color(s_active_scene.warm, s_active_scene.neutral,
-                             s_active_scene.cool);
-        flame_mode_set_scene_master(s_active_scene.master);
-        flame_mode_start();
+        lamp_effect_set_color(s_active_scene.warm, s_active_scene.neutral,
+                              s_active_scene.cool);
+        lamp_effect_set_scene_master(s_active_scene.master);
+        lamp_effect_start(s_active_scene.effect_id);
     }
     if (s_flags & MODE_FLAG_CIRCADIAN) {
         circadian_mode_enable();
     }
     if (!(s_flags & (MODE_FLAG_AUTO | MODE_FLAG_FLAME | MODE_FLAG_CIRCADIAN))) {
-        apply_manual_scene();
+        apply_manual_scene(0);
     }
 
     /* Create the event-loop task */
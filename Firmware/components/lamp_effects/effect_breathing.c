@@ -0,0 +1,28 @@
+#include <math.h>
+#include <string.h>
+#include "lamp_effects_internal.h"
+
+/*
+ * Breathing — the whole lamp swells and falls on a raised cosine between
+ * CONFIG_LAMP_EFFECTS_BREATHING_FLOOR and full intensity, starting at the
+ * floor.
+ */
+
+#define BREATH_PERIOD_US    ((int64_t)CONFIG_LAMP_EFFECTS_BREATHING_PERIOD_MS * 1000)
+#define BREATH_FLOOR        CONFIG_LAMP_EFFECTS_BREATHING_FLOOR
+
+static bool breathing_render(int64_t t_us, uint8_t *level, int count)
+{
+    /* One cosf per frame — the same value goes to every LED */
+    float phase = (float)(t_us % BREATH_PERIOD_US) / (float)BREATH_PERIOD_US;
+    float swell = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * phase);
+    uint8_t v = BREATH_FLOOR + (uint8_t)(swell * (255 - BREATH_FLOOR) + 0.5f);
+    memset(level, v, count);
+    return true;
+}
+
+const lamp_effect_t breathing_effect = {
+    .id     = EFFECT_ID_BREATHING,
+    .name   = "breathing",
+    .render = breathing_render,
+};
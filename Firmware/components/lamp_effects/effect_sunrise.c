@@ -0,0 +1,39 @@
+#include "led_driver.h"
+#include "lamp_effects_internal.h"
+
+/*
+ * Sunrise — a slow ramp from dark to full intensity that rises through the
+ * lamp: each row starts a little after the one below it (led_coords row 6
+ * is the bottom), so light climbs from the base.  Once every LED is at
+ * full the frame is held and the render task goes idle.
+ */
+
+#define SUNRISE_US      ((int64_t)CONFIG_LAMP_EFFECTS_SUNRISE_MINUTES * 60 * 1000000)
+#define SUNRISE_ROWS    7
+#define SUNRISE_SPREAD  (65536 * 3 / 10)    /* top row lags by 30 % of the ramp (Q16) */
+
+static bool sunrise_render(int64_t t_us, uint8_t *level, int count)
+{
+    /* Progress of the whole ramp in Q16, 0 → 1 */
+    int32_t q = t_us >= SUNRISE_US ? 65536 : (int32_t)(t_us * 65536 / SUNRISE_US);
+    bool rising = false;
+
+    for (int i = 0; i < count; i++) {
+        int32_t delay = (SUNRISE_ROWS - 1 - led_coords[i].row) * SUNRISE_SPREAD / (SUNRISE_ROWS - 1);
+        int32_t x = q - delay;
+        int32_t v = x <= 0 ? 0 : (int32_t)((int64_t)x * 255 / (65536 - SUNRISE_SPREAD));
+        if (v >= 255) {
+            v = 255;
+        } else {
+            rising = true;
+        }
+        level[i] = (uint8_t)v;
+    }
+    return rising;
+}
+
+const lamp_effect_t sunrise_effect = {
+    .id     = EFFECT_ID_SUNRISE,
+    .name   = "sunrise",
+    .render = sunrise_render,
+};
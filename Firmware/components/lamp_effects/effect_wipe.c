@@ -0,0 +1,38 @@
+#include "led_driver.h"
+#include "lamp_effects_internal.h"
+
+/*
+ * Wipe — a soft edge one column wide sweeps left to right across
+ * led_coords, lighting the lamp column by column, then sweeps again to
+ * clear it.
+ */
+
+#define WIPE_PERIOD_US  ((int64_t)CONFIG_LAMP_EFFECTS_WIPE_PERIOD_MS * 1000)
+#define WIPE_COLS       5
+#define WIPE_TRAVEL     ((WIPE_COLS + 1) * 256)     /* edge position range, 1/256 column */
+
+static bool wipe_render(int64_t t_us, uint8_t *level, int count)
+{
+    /* First half of the period lights, second half clears */
+    int64_t t = t_us % WIPE_PERIOD_US;
+    int64_t half = WIPE_PERIOD_US / 2;
+    bool clearing = t >= half;
+    if (clearing) t -= half;
+    int32_t edge = (int32_t)(t * WIPE_TRAVEL / half);
+
+    for (int i = 0; i < count; i++) {
+        /* Coverage of this LED's column by the edge: 0 … 256 */
+        int32_t cover = edge - led_coords[i].col * 256;
+        if (cover < 0) cover = 0;
+        if (cover > 256) cover = 256;
+        int32_t v = cover * 255 / 256;
+        level[i] = (uint8_t)(clearing ? 255 - v : v);
+    }
+    return true;
+}
+
+const lamp_effect_t wipe_effect = {
+    .id     = EFFECT_ID_WIPE,
+    .name   = "wipe",
+    .render = wipe_render,
+};
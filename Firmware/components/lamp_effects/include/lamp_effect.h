@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "lamp_nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Effect engine — animated modes as plug-in effects on the render task.
+ *
+ * An effect only produces an intensity map (compositor effect layer, one
+ * byte per LED in led_coords order); the engine owns the base colour,
+ * master brightness, the single render-task animator and start/stop.
+ * Effects are looked up by EFFECT_ID_* in a registry filled at boot: the
+ * built-ins by lamp_effect_init(), effects in other components (flame_mode)
+ * by lamp_effect_register() — so adding an effect is a lamp_effect_t and a
+ * registration, with no task, stack or lock of its own.
+ *
+ * At most one effect runs at a time.  The engine API is called from the
+ * control and BLE tasks; render callbacks run on the render task.
+ */
+
+typedef struct {
+    uint8_t     id;         /* EFFECT_ID_* */
+    const char *name;
+
+    /** Once at boot (optional). */
+    esp_err_t (*init)(void);
+
+    /** Scene applied: pick up per-scene parameters (optional).  May be
+     *  called while the effect is rendering. */
+    void (*configure)(const scene_t *scene);
+
+    /** About to render from t = 0 (optional).  Runs in the caller of
+     *  lamp_effect_start() and may block (e.g. to prepare a table). */
+    esp_err_t (*start)(void);
+
+    /**
+     * Render one frame on the render task.
+     * @param t_us   Time since the first frame (0 on the first call).
+     *               Frames come at the adaptive render rate
+     *               (lamp_render.h), so animate by t_us, not per call.
+     * @param level  Intensity per LED, 255 = base colour at full.
+     * @param count  Number of entries in @p level (LED_COUNT).
+     * @return false once the output will not change any more: the last
+     *         frame is held and the render task stops ticking for it.
+     *
+     * An effect that needs its own colours may also repaint the base layer
+     * (lamp_set_pixels); the engine refills it with the scene colour on
+     * start and on lamp_effect_set_color().
+     */
+    bool (*render)(int64_t t_us, uint8_t *level, int count);
+
+    /** Stopped (optional).  Runs after the last render call has returned. */
+    void (*stop)(void);
+} lamp_effect_t;
+
+#define LAMP_EFFECT_MAX     8       /* registry size */
+
+/**
+ * Add an effect to the registry.  Call at boot, before lamp_effect_init();
+ * @p fx must stay valid (normally a const descriptor).
+ * @return ESP_ERR_INVALID_STATE if its id is taken, ESP_ERR_NO_MEM if the
+ *         registry is full.
+ */
+esp_err_t lamp_effect_register(const lamp_effect_t *fx);
+
+/**
+ * Register the built-in effects and run every registered effect's init.
+ * Call once, after the other components' lamp_effect_register(), before
+ * any other lamp_effect function.
+ */
+esp_err_t lamp_effect_init(void);
+
+/**
+ * Pass a scene to every registered effect's configure.
+ */
+void lamp_effect_configure(const scene_t *scene);
+
+/**
+ * Look up a registered effect (NULL if @p id is unknown).
+ */
+const lamp_effect_t *lamp_effect_find(uint8_t id);
+
+/**
+ * Start effect @p id over the current base colour and master.  If another
+ * effect is running it is replaced without blanking the LEDs; starting the
+ * running effect again is a no-op.  Unknown IDs fall back to
+ * EFFECT_ID_DEFAULT (the flame), or the first registered effect.
+ */
+esp_err_t lamp_effect_start(uint8_t id);
+
+/**
+ * Stop the running effect and turn off the LEDs.
+ */
+void lamp_effect_stop(void);
+
+/**
+ * Returns true if an effect is running.
+ */
+bool lamp_effect_is_active(void);
+
+/**
+ * Base colour under the effect (compositor base layer).  Applied
+ * immediately while running, otherwise on the next start.
+ */
+void lamp_effect_set_color(uint8_t warm, uint8_t neutral, uint8_t cool);
+
+/**
+ * Scene master brightness (0–255) while an effect runs.
+ */
+void lamp_effect_set_scene_master(uint8_t master);
+
+/**
+ * Glide base colour and scene master to new values over @p duration_ms
+ * (0, or no effect running: same as the two setters above).  The colour is
+ * stepped on the effect's animator just before each frame renders, so an
+ * effect that repaints the base layer keeps its own colours; the master
+ * goes through the fade engine (lamp_fade.h).
+ */
+void lamp_effect_fade_to(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t master,
+                         uint32_t duration_ms);
+
+/**
+ * Highest frame rate the running effect can use (lamp_animator_set_fps).
+ * Call from the effect's start or render; reset to LAMP_RENDER_FPS on
+ * every start.
+ */
+void lamp_effect_set_fps(uint8_t fps);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,299 @@
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "led_driver.h"
+#include "lamp_render.h"
+#include "lamp_fade.h"
+#include "lamp_effect.h"
+#include "lamp_effects_internal.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+
+static const char *TAG = "effects";
+
+/* Built-in effects, registered by lamp_effect_init() after any effect
+ * registered by another component (lamp_effect_register) */
+static const lamp_effect_t *const s_builtin[] = {
+    &breathing_effect,
+    &sunrise_effect,
+    &wipe_effect,
+};
+
+/* Registry — filled at boot, read-only afterwards */
+static const lamp_effect_t *s_effects[LAMP_EFFECT_MAX];
+static size_t               s_effect_count;
+
+static const lamp_effect_t *volatile s_active;   /* NULL = no effect running */
+
+/* Base colour and master applied while an effect runs */
+static volatile uint8_t s_color_w = 255;
+static volatile uint8_t s_color_n = 0;
+static volatile uint8_t s_color_c = 0;
+static volatile uint8_t s_scene_master = 255;
+
+/* Base colour glide (lamp_effect_fade_to): from s_glide_from at
+ * s_glide_start_us to s_color_* over s_glide_duration_us (0 = none).
+ * Shared between the caller and the render task. */
+static portMUX_TYPE s_glide_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t      s_glide_from[3];
+static int64_t      s_glide_start_us;
+static int64_t      s_glide_duration_us;
+
+/* Render task: timestamp of the active effect's first frame */
+static int64_t s_t0_us;
+static bool    s_first;
+
+/* Requested frame rate of the running effect, and the rate passed to the
+ * render task (applied from the animator, where the effect is known) */
+static volatile uint8_t s_fps = LAMP_RENDER_FPS;
+static uint8_t          s_fps_applied;
+
+/* Start latency: lamp_effect_start() entry → first frame on the render task.
+ * The call time is logged by lamp_effect_start() itself: the first frame
+ * can be drawn before the call returns. */
+static int64_t s_start_us;
+
+/* ── Colour glide ── */
+
+/* Glide colour at @p now_us (smoothstep); false once it has arrived.  O(1)
+ * per frame.  Call under s_glide_lock. */
+static bool glide_color(int64_t now_us, uint8_t out[3])
+{
+    const uint8_t to[3] = { s_color_w, s_color_n, s_color_c };
+    int64_t elapsed = now_us - s_glide_start_us;
+    if (s_glide_duration_us == 0 || elapsed >= s_glide_duration_us) {
+        for (int i = 0; i < 3; i++) out[i] = to[i];
+        return false;
+    }
+    uint32_t t = (uint32_t)((elapsed << 16) / s_glide_duration_us);
+    int32_t  e = (int32_t)(((uint64_t)t * t * (3 * 65536u - 2 * t)) >> 32);
+    for (int i = 0; i < 3; i++) {
+        out[i] = (uint8_t)(s_glide_from[i] + (((to[i] - s_glide_from[i]) * e + 32768) >> 16));
+    }
+    return true;
+}
+
+static void glide_cancel(void)
+{
+    taskENTER_CRITICAL(&s_glide_lock);
+    s_glide_duration_us = 0;
+    taskEXIT_CRITICAL(&s_glide_lock);
+}
+
+/* ── Animator ── */
+
+static bool effect_animate(int64_t now_us, void *arg)
+{
+    const lamp_effect_t *fx = arg;
+    if (s_first) {
+        s_first = false;
+        s_t0_us = now_us;
+    }
+
+    /* Before render, so an effect that repaints the base layer wins */
+    bool gliding = false;
+    if (s_glide_duration_us) {
+        uint8_t c[3];
+        taskENTER_CRITICAL(&s_glide_lock);
+        gliding = glide_color(now_us, c);
+        if (!gliding) s_glide_duration_us = 0;
+        taskEXIT_CRITICAL(&s_glide_lock);
+        lamp_fill(c[0], c[1], c[2]);
+    }
+
+    uint8_t level[LED_COUNT];
+    bool more = fx->render(now_us - s_t0_us, level, LED_COUNT);
+
+    uint8_t fps = s_fps;
+    if (fps != s_fps_applied) {
+        s_fps_applied = fps;
+        lamp_animator_set_fps(effect_animate, arg, fps);
+    }
+
+    if (s_start_us) {
+        ESP_LOGI(TAG, "Start latency: first frame %lld us",
+                 esp_timer_get_time() - s_start_us);
+        s_start_us = 0;
+    }
+
+    /* The render task flushes after all animators have run */
+    lamp_set_effect(level);
+    lamp_flush();
+    /* A held frame keeps ticking until the glide has arrived */
+    return more || gliding;
+}
+
+/* Unregister the running effect's animator and let it clean up, leaving
+ * the frame buffer as it is */
+static void effect_halt(const lamp_effect_t *fx)
+{
+    /* Returns once any in-progress frame has been written */
+    lamp_animator_stop(effect_animate, (void *)fx);
+    if (fx->stop) fx->stop();
+}
+
+/* ── Public API ── */
+
+esp_err_t lamp_effect_register(const lamp_effect_t *fx)
+{
+    ESP_RETURN_ON_FALSE(fx && fx->render, ESP_ERR_INVALID_ARG, TAG, "invalid effect");
+    ESP_RETURN_ON_FALSE(!lamp_effect_find(fx->id), ESP_ERR_INVALID_STATE, TAG,
+                        "effect id %u already registered", fx->id);
+    ESP_RETURN_ON_FALSE(s_effect_count < LAMP_EFFECT_MAX, ESP_ERR_NO_MEM, TAG,
+                        "registry full (%s)", fx->name);
+    s_effects[s_effect_count++] = fx;
+    return ESP_OK;
+}
+
+esp_err_t lamp_effect_init(void)
+{
+    for (size_t i = 0; i < sizeof(s_builtin) / sizeof(s_builtin[0]); i++) {
+        ESP_RETURN_ON_ERROR(lamp_effect_register(s_builtin[i]), TAG, "built-in register failed");
+    }
+    for (size_t i = 0; i < s_effect_count; i++) {
+        if (s_effects[i]->init) {
+            ESP_RETURN_ON_ERROR(s_effects[i]->init(), TAG, "%s init failed", s_effects[i]->name);
+        }
+    }
+    return ESP_OK;
+}
+
+void lamp_effect_configure(const scene_t *scene)
+{
+    for (size_t i = 0; i < s_effect_count; i++) {
+        if (s_effects[i]->configure) s_effects[i]->configure(scene);
+    }
+}
+
+const lamp_effect_t *lamp_effect_find(uint8_t id)
+{
+    for (size_t i = 0; i < s_effect_count; i++) {
+        if (s_effects[i]->id == id) return s_effects[i];
+    }
+    return NULL;
+}
+
+esp_err_t lamp_effect_start(uint8_t id)
+{
+    const lamp_effect_t *fx = lamp_effect_find(id);
+    if (!fx) {
+        fx = lamp_effect_find(EFFECT_ID_DEFAULT);
+        if (!fx) fx = s_effects[0];
+        ESP_RETURN_ON_FALSE(fx, ESP_ERR_NOT_FOUND, TAG, "no effects registered");
+        ESP_LOGW(TAG, "Unknown effect %u — using %s", id, fx->name);
+    }
+    const lamp_effect_t *old = s_active;
+    if (fx == old) return ESP_OK;
+
+    int64_t t0 = esp_timer_get_time();
+    if (old) {
+        effect_halt(old);
+        s_active = NULL;
+    }
+
+    ESP_LOGI(TAG, "Starting %s: color=[%d,%d,%d] scene_master=%d", fx->name,
+             s_color_w, s_color_n, s_color_c, s_scene_master);
+    s_fps         = LAMP_RENDER_FPS;
+    s_fps_applied = LAMP_RENDER_FPS;    /* lamp_animator_start() default */
+    if (fx->start) ESP_RETURN_ON_ERROR(fx->start(), TAG, "%s start failed", fx->name);
+
+    s_first    = true;
+    s_start_us = t0;
+    lamp_fill(s_color_w, s_color_n, s_color_c);
+    lamp_set_master(s_scene_master);
+    /* The render task is already running; registering the animator wakes
+     * it and the first frame is drawn on that wake-up */
+    esp_err_t ret = lamp_animator_start(effect_animate, (void *)fx);
+    if (ret != ESP_OK) {
+        if (fx->stop) fx->stop();
+        return ret;
+    }
+    s_active = fx;
+
+    ESP_LOGI(TAG, "Effect %s started (call %lld us, up to %u fps)", fx->name,
+             esp_timer_get_time() - t0, s_fps);
+    return ESP_OK;
+}
+
+void lamp_effect_stop(void)
+{
+    const lamp_effect_t *fx = s_active;
+    if (!fx) return;
+    s_active = NULL;
+    glide_cancel();
+
+    /* The blackout below is never overwritten by a late effect frame */
+    int64_t t0 = esp_timer_get_time();
+    effect_halt(fx);
+    lamp_set_effect(NULL);
+    lamp_off();
+    ESP_LOGI(TAG, "Effect %s stopped (call %lld us)", fx->name, esp_timer_get_time() - t0);
+}
+
+bool lamp_effect_is_active(void)
+{
+    return s_active != NULL;
+}
+
+void lamp_effect_set_color(uint8_t warm, uint8_t neutral, uint8_t cool)
+{
+    glide_cancel();
+    s_color_w = warm;
+    s_color_n = neutral;
+    s_color_c = cool;
+    /* Flush too: a held frame (render returned false) has no animator */
+    if (s_active) {
+        lamp_fill(warm, neutral, cool);
+        lamp_flush();
+    }
+    ESP_LOGI(TAG, "set_color: [%d,%d,%d]", warm, neutral, cool);
+}
+
+void lamp_effect_set_scene_master(uint8_t master)
+{
+    ESP_LOGI(TAG, "scene_master: %d", master);
+    s_scene_master = master;
+    if (s_active) {
+        /* Zero-length fade: also ends a master glide still in progress */
+        const lamp_fade_level_t to = { .master = master };
+        lamp_fade_to(&to, LAMP_FADE_MASTER, 0, LAMP_EASE_LINEAR, NULL, NULL);
+    }
+}
+
+void lamp_effect_fade_to(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t master,
+                         uint32_t duration_ms)
+{
+    const lamp_effect_t *fx = s_active;
+    if (!fx || duration_ms == 0) {
+        lamp_effect_set_color(warm, neutral, cool);
+        lamp_effect_set_scene_master(master);
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_glide_lock);
+    glide_color(now, s_glide_from);     /* from what shows, mid-glide included */
+    s_color_w = warm;
+    s_color_n = neutral;
+    s_color_c = cool;
+    s_glide_start_us    = now;
+    s_glide_duration_us = (int64_t)duration_ms * 1000;
+    taskEXIT_CRITICAL(&s_glide_lock);
+
+    s_scene_master = master;
+    const lamp_fade_level_t to = { .master = master };
+    lamp_fade_to(&to, LAMP_FADE_MASTER, duration_ms, LAMP_EASE_IN_OUT, NULL, NULL);
+
+    /* A held frame has no animator — bring it back for the glide */
+    if (!lamp_animator_is_running(effect_animate, (void *)fx)) {
+        s_fps_applied = LAMP_RENDER_FPS;
+        lamp_animator_start(effect_animate, (void *)fx);
+    }
+    ESP_LOGI(TAG, "fade_to: [%d,%d,%d] master=%d over %lu ms",
+             warm, neutral, cool, master, (unsigned long)duration_ms);
+}
+
+void lamp_effect_set_fps(uint8_t fps)
+{
+    s_fps = fps;
+}
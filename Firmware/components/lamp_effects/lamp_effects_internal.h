@@ -0,0 +1,8 @@
+#pragma once
+
+#include "lamp_effect.h"
+
+/* Built-in effects registered in lamp_effects.c */
+extern const lamp_effect_t breathing_effect;
+extern const lamp_effect_t sunrise_effect;
+extern const lamp_effect_t wipe_effect;
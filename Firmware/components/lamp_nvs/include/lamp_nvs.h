@@ -32,6 +32,20 @@ extern "C" {
 #define FLAME_FLICKER_SPEED_DEFAULT  13
 #define PIR_SENSITIVITY_DEFAULT      24
 
+/* Flame rendering style */
+#define FLAME_STYLE_LIVE             0   /* computed every frame */
+#define FLAME_STYLE_BAKED            1   /* looped clip baked into flash */
+#define FLAME_STYLE_PARTICLES        2   /* live, with rising embers */
+#define FLAME_STYLE_FIRE             3   /* cellular fire, own palette */
+#define FLAME_STYLE_DEFAULT          FLAME_STYLE_LIVE
+
+/* Effect run while MODE_FLAG_FLAME is set (registry in lamp_effects) */
+#define EFFECT_ID_FLAME              0
+#define EFFECT_ID_BREATHING          1
+#define EFFECT_ID_SUNRISE            2
+#define EFFECT_ID_WIPE               3
+#define EFFECT_ID_DEFAULT            EFFECT_ID_FLAME
+
 typedef struct {
     char     name[SCENE_NAME_MAX + 1];
     uint8_t  warm;
@@ -52,6 +66,8 @@ typedef struct {
     uint8_t  flame_flicker_depth;
     uint8_t  flame_flicker_speed;
     uint8_t  pir_sensitivity;    /* 0–31 */
+    uint8_t  flame_style;        /* FLAME_STYLE_* */
+    uint8_t  effect_id;          /* EFFECT_ID_* */
 } scene_t;
 
 typedef struct {
@@ -76,11 +92,12 @@ typedef struct {
     uint8_t bias_y;
     uint8_t flicker_depth;
     uint8_t flicker_speed;
+    uint8_t style;          /* FLAME_STYLE_* */
 } flame_config_t;
 
 /* Lamp mode flags (bitmask) */
 #define MODE_FLAG_AUTO      (1 << 0)   /* 0x01 */
-#define MODE_FLAG_FLAME     (1 << 1)   /* 0x02 */
+#define MODE_FLAG_FLAME     (1 << 1)   /* 0x02 — effect mode; scene.effect_id picks the effect */
 #define MODE_FLAG_CIRCADIAN (1 << 2)   /* 0x04 — app-side only, firmware passes through */
 #define MODE_FLAGS_MASK     (MODE_FLAG_AUTO | MODE_FLAG_FLAME | MODE_FLAG_CIRCADIAN)
 
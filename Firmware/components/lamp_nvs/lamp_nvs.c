@@ -73,6 +73,8 @@ static void scene_set_new_field_defaults(scene_t *scene)
     scene->flame_flicker_depth = FLAME_FLICKER_DEPTH_DEFAULT;
     scene->flame_flicker_speed = FLAME_FLICKER_SPEED_DEFAULT;
     scene->pir_sensitivity     = PIR_SENSITIVITY_DEFAULT;
+    scene->flame_style         = FLAME_STYLE_DEFAULT;
+    scene->effect_id           = EFFECT_ID_DEFAULT;
 }
 
 esp_err_t lamp_nvs_load_active_scene(scene_t *scene)
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Power management — dynamic frequency scaling and, with
+ * CONFIG_LAMP_PM_LIGHT_SLEEP, automatic light sleep whenever no PM lock is
+ * held (lamp off or static).  Wake sources: PIR and touch GPIO levels
+ * (configured by the sensor component), esp_timer deadlines (lamp_timer)
+ * and the ESP-NOW listen window (esp_now_sync).
+ */
+
+/**
+ * Configure esp_pm and enable GPIO wake-up.  Call after
+ * lamp_timer_service_init() and before the radios are started.
+ * Returns ESP_OK without doing anything when CONFIG_PM_ENABLE is off.
+ */
+esp_err_t lamp_pm_init(void);
+
+/**
+ * Log light sleep vs active time since the last report
+ * (CONFIG_LAMP_PM_STATS; otherwise logs the PM configuration only).
+ */
+void lamp_pm_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
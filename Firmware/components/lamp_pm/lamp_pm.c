@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "lamp_pm.h"
+#include "lamp_timer.h"
+
+static const char *TAG = "lamp_pm";
+
+#if CONFIG_LAMP_PM_STATS
+/* Light sleep totals, added by the PM exit callback on the idle task */
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t      s_slept_us;
+static uint32_t     s_sleeps;
+static int64_t      s_window_start_us;
+static lamp_timer_t s_report_timer;
+
+static esp_err_t IRAM_ATTR sleep_exit_cb(int64_t slept_us, void *arg)
+{
+    taskENTER_CRITICAL_ISR(&s_stats_lock);
+    s_slept_us += slept_us;
+    s_sleeps++;
+    taskEXIT_CRITICAL_ISR(&s_stats_lock);
+    return ESP_OK;
+}
+
+static void stats_report(bool reset)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&s_stats_lock);
+    int64_t  slept  = s_slept_us;
+    uint32_t sleeps = s_sleeps;
+    int64_t  window = now - s_window_start_us;
+    if (reset) {
+        s_slept_us        = 0;
+        s_sleeps          = 0;
+        s_window_start_us = now;
+    }
+    taskEXIT_CRITICAL(&s_stats_lock);
+
+    if (window <= 0) return;
+    if (slept > window) slept = window;
+    ESP_LOGI(TAG, "Last %lu s: light sleep %lu.%03lu s (%lu.%lu%%) in %lu sleeps, active %lu.%03lu s",
+             (unsigned long)(window / 1000000),
+             (unsigned long)(slept / 1000000), (unsigned long)(slept / 1000 % 1000),
+             (unsigned long)(slept * 100 / window), (unsigned long)(slept * 1000 / window % 10),
+             (unsigned long)sleeps,
+             (unsigned long)((window - slept) / 1000000),
+             (unsigned long)((window - slept) / 1000 % 1000));
+#if CONFIG_PM_PROFILING
+    /* Who kept the chip awake */
+    esp_pm_dump_locks(stdout);
+#endif
+}
+
+static void report_cb(void *arg)
+{
+    stats_report(true);
+}
+#endif /* CONFIG_LAMP_PM_STATS */
+
+esp_err_t lamp_pm_init(void)
+{
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t cfg = {
+        .max_freq_mhz       = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz       = CONFIG_LAMP_PM_MIN_FREQ_MHZ,
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+        .light_sleep_enable = true,
+#endif
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_configure(&cfg), TAG, "PM configure failed");
+
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    /* The sensor component arms PIR and touch as level wake-up pins */
+    ESP_RETURN_ON_ERROR(esp_sleep_enable_gpio_wakeup(), TAG, "GPIO wake-up enable failed");
+#endif
+
+#if CONFIG_LAMP_PM_STATS
+    esp_pm_sleep_cbs_register_config_t cbs = {
+        .exit_cb = sleep_exit_cb,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_light_sleep_register_cbs(&cbs), TAG, "sleep callback register failed");
+    s_window_start_us = esp_timer_get_time();
+    lamp_timer_init(&s_report_timer, "pm_report", report_cb, NULL);
+    lamp_timer_start_periodic(&s_report_timer, CONFIG_LAMP_PM_STATS_PERIOD_S * 1000000ULL);
+#endif
+
+    ESP_LOGI(TAG, "Power management: %d-%d MHz, light sleep %s",
+             CONFIG_LAMP_PM_MIN_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             cfg.light_sleep_enable ? "on" : "off");
+#else
+    ESP_LOGI(TAG, "Power management disabled (CONFIG_PM_ENABLE)");
+#endif
+    return ESP_OK;
+}
+
+void lamp_pm_log_stats(void)
+{
+#if CONFIG_LAMP_PM_STATS
+    stats_report(false);
+#elif CONFIG_PM_ENABLE
+    ESP_LOGI(TAG, "Sleep statistics need CONFIG_LAMP_PM_STATS");
+#if CONFIG_PM_PROFILING
+    esp_pm_dump_locks(stdout);
+#endif
+#endif
+}
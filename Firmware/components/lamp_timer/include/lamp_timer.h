@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Timer service — the sensor, auto and circadian deadlines in one
+ * hierarchical timer wheel (3 levels × 64 slots, LAMP_TIMER_TICK_US
+ * resolution) with a single esp_timer armed to the earliest deadline.
+ *
+ * Callbacks do not run on the esp_timer task: the hardware timer only
+ * calls the wake hook, and the owning task (lamp_control's event loop)
+ * runs every due callback from lamp_timer_run().  Callbacks are therefore
+ * ordered with the events on that task's queue, one at a time, and may
+ * block briefly, post events and start or stop timers.
+ *
+ * Timers are caller-owned structs (no allocation).  Start and stop are
+ * safe from any task; stopping a timer that is due but not yet run keeps
+ * its callback from running.  Deadlines are rounded up to the next tick,
+ * so a timer never fires early.
+ */
+
+#define LAMP_TIMER_TICK_US      10000
+#define LAMP_TIMER_HIST_BINS    12      /* bin i counts runs < (16 << i) µs */
+
+typedef void (*lamp_timer_cb_t)(void *arg);
+
+typedef struct lamp_timer {
+    /* Private — set up by lamp_timer_init() */
+    struct lamp_timer  *next;           /* wheel slot / due list */
+    struct lamp_timer **pprev;          /* NULL = not pending */
+    struct lamp_timer  *all_next;       /* every initialised timer, for stats */
+    const char         *name;
+    lamp_timer_cb_t     cb;
+    void               *arg;
+    uint64_t            expires;        /* tick */
+    uint32_t            period;         /* ticks, 0 = one-shot */
+
+    /* Callback runtime (read with lamp_timer_log_stats()) */
+    uint32_t            runs;
+    uint32_t            max_us;
+    uint32_t            bins[LAMP_TIMER_HIST_BINS];
+} lamp_timer_t;
+
+/**
+ * Create the wheel and its hardware timer.  Call once at boot, before any
+ * module initialises a timer.
+ */
+esp_err_t lamp_timer_service_init(void);
+
+/**
+ * Set the hook the hardware timer calls when a deadline is reached (runs on
+ * the esp_timer task — just wake the owning task, which then calls
+ * lamp_timer_run()).
+ */
+void lamp_timer_set_wake(void (*wake)(void));
+
+/**
+ * Run every due callback.  Call from the owning task only: whenever the
+ * wake hook fires, and harmlessly at any other time.
+ */
+void lamp_timer_run(void);
+
+/**
+ * Set up a timer (stopped).  @p name is kept for the stats log.
+ */
+void lamp_timer_init(lamp_timer_t *t, const char *name, lamp_timer_cb_t cb, void *arg);
+
+/**
+ * (Re)start @p t to fire once, @p delay_us from now.
+ */
+void lamp_timer_start_once(lamp_timer_t *t, uint64_t delay_us);
+
+/**
+ * (Re)start @p t to fire every @p period_us, the first time one period
+ * from now.  Periods are whole ticks (at least one); a late run does not
+ * cause catch-up runs.
+ */
+void lamp_timer_start_periodic(lamp_timer_t *t, uint64_t period_us);
+
+/**
+ * Stop @p t (no-op if not running).  Does not wait for a callback that is
+ * already running.
+ */
+void lamp_timer_stop(lamp_timer_t *t);
+
+/**
+ * Returns true while @p t is waiting to fire.
+ */
+bool lamp_timer_is_active(const lamp_timer_t *t);
+
+/**
+ * Log wakeups and each timer's run count and runtime histogram at INFO.
+ */
+void lamp_timer_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
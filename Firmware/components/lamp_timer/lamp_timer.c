@@ -0,0 +1,284 @@
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "lamp_timer.h"
+
+static const char *TAG = "lamp_timer";
+
+/*
+ * Three levels of 64 slots.  A pending timer sits in level 0 if it is due
+ * within 64 ticks (slot = expiry tick), in level 1 within 64² ticks and in
+ * level 2 beyond that (clamped to the level 2 horizon of ~44 min at 10 ms).
+ * Whenever the tick crosses a level-1 / level-2 slot boundary, that slot's
+ * timers are re-inserted one level closer; level-0 slots are simply due
+ * when their tick comes up.  Start, stop and expiry are O(1); finding the
+ * next deadline to arm the hardware timer scans the slot heads.
+ */
+#define WHEEL_BITS      6
+#define WHEEL_SIZE      (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS    3
+#define WHEEL_SPAN(l)   (1ULL << (WHEEL_BITS * ((l) + 1)))  /* ticks covered by levels 0..l */
+
+static lamp_timer_t     *s_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static lamp_timer_t     *s_due;         /* expired, waiting for lamp_timer_run() */
+static lamp_timer_t     *s_all;
+static uint64_t          s_tick;        /* last tick the wheel was advanced to */
+static uint64_t          s_armed;       /* tick the hardware timer is set for */
+static uint32_t          s_wakeups;
+
+static StaticSemaphore_t  s_lock_buf;
+static SemaphoreHandle_t  s_lock;
+static esp_timer_handle_t s_hw;
+static void (*volatile s_wake)(void);
+
+/* ── Lists ── */
+
+static void list_add(lamp_timer_t **head, lamp_timer_t *t)
+{
+    t->next = *head;
+    if (t->next) t->next->pprev = &t->next;
+    *head = t;
+    t->pprev = head;
+}
+
+static void list_del(lamp_timer_t *t)
+{
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next  = NULL;
+    t->pprev = NULL;
+}
+
+/* ── Wheel (call under s_lock) ── */
+
+static uint64_t now_tick(void)
+{
+    return (uint64_t)esp_timer_get_time() / LAMP_TIMER_TICK_US;
+}
+
+static void wheel_insert(lamp_timer_t *t)
+{
+    if (t->expires <= s_tick) {
+        list_add(&s_due, t);
+        return;
+    }
+    uint64_t delta = t->expires - s_tick;
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= WHEEL_SPAN(level)) level++;
+
+    uint64_t at = t->expires;
+    if (delta >= WHEEL_SPAN(WHEEL_LEVELS - 1)) {
+        at = s_tick + WHEEL_SPAN(WHEEL_LEVELS - 1) - 1;    /* re-inserted on cascade */
+    }
+    list_add(&s_wheel[level][(at >> (WHEEL_BITS * level)) & WHEEL_MASK], t);
+}
+
+static void wheel_cascade(int level, uint64_t tick)
+{
+    lamp_timer_t **slot = &s_wheel[level][(tick >> (WHEEL_BITS * level)) & WHEEL_MASK];
+    lamp_timer_t *t = *slot;
+    *slot = NULL;
+    while (t) {
+        lamp_timer_t *next = t->next;
+        t->pprev = NULL;
+        wheel_insert(t);
+        t = next;
+    }
+}
+
+/* Move the wheel up to @p to, collecting expired timers on s_due */
+static void wheel_advance(uint64_t to)
+{
+    while (s_tick < to) {
+        s_tick++;
+        for (int level = WHEEL_LEVELS - 1; level > 0; level--) {
+            if ((s_tick & (WHEEL_SPAN(level - 1) - 1)) == 0) wheel_cascade(level, s_tick);
+        }
+        lamp_timer_t **slot = &s_wheel[0][s_tick & WHEEL_MASK];
+        while (*slot) {
+            lamp_timer_t *t = *slot;
+            list_del(t);
+            list_add(&s_due, t);
+        }
+    }
+}
+
+/* Earliest pending expiry tick (UINT64_MAX if none) */
+static uint64_t wheel_next(void)
+{
+    if (s_due) return s_tick;
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        for (int i = 0; i < WHEEL_SIZE; i++) {
+            for (lamp_timer_t *t = s_wheel[level][i]; t; t = t->next) {
+                if (t->expires < next) next = t->expires;
+            }
+        }
+    }
+    return next;
+}
+
+/* Point the hardware timer at the earliest deadline */
+static void wheel_arm(void)
+{
+    uint64_t next = wheel_next();
+    if (next == s_armed && esp_timer_is_active(s_hw)) return;
+
+    esp_timer_stop(s_hw);
+    s_armed = next;
+    if (next == UINT64_MAX) return;
+
+    int64_t delay = (int64_t)(next * LAMP_TIMER_TICK_US) - esp_timer_get_time();
+    esp_timer_start_once(s_hw, delay > 0 ? (uint64_t)delay : 0);
+}
+
+static void hist_add(lamp_timer_t *t, uint32_t us)
+{
+    int bin = (us < 16) ? 0 : (32 - __builtin_clz(us)) - 4;
+    if (bin >= LAMP_TIMER_HIST_BINS) bin = LAMP_TIMER_HIST_BINS - 1;
+    t->bins[bin]++;
+    t->runs++;
+    if (us > t->max_us) t->max_us = us;
+}
+
+/* ── Hardware timer (esp_timer task) ── */
+
+static void hw_timer_cb(void *arg)
+{
+    void (*wake)(void) = s_wake;
+    if (wake) wake();
+}
+
+/* ── Public API ── */
+
+esp_err_t lamp_timer_service_init(void)
+{
+    s_lock = xSemaphoreCreateMutexStatic(&s_lock_buf);
+    ESP_RETURN_ON_FALSE(s_lock, ESP_FAIL, TAG, "lock create failed");
+
+    esp_timer_create_args_t args = {
+        .callback = hw_timer_cb,
+        .name     = "lamp_timer",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&args, &s_hw), TAG, "timer create failed");
+
+    s_tick  = now_tick();
+    s_armed = UINT64_MAX;
+    ESP_LOGI(TAG, "Timer wheel ready (%d levels x %d slots, tick %d ms)",
+             WHEEL_LEVELS, WHEEL_SIZE, LAMP_TIMER_TICK_US / 1000);
+    return ESP_OK;
+}
+
+void lamp_timer_set_wake(void (*wake)(void))
+{
+    s_wake = wake;
+}
+
+void lamp_timer_run(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_wakeups++;
+    wheel_advance(now_tick());
+
+    /* One at a time with the lock released, so a callback can start or
+     * stop timers, and a timer stopped meanwhile is no longer on s_due */
+    while (s_due) {
+        lamp_timer_t *t = s_due;
+        list_del(t);
+        if (t->period) {
+            t->expires += t->period;
+            if (t->expires <= s_tick) t->expires = s_tick + t->period;   /* no catch-up */
+            wheel_insert(t);
+        }
+        lamp_timer_cb_t cb = t->cb;
+        void *arg = t->arg;
+        xSemaphoreGive(s_lock);
+
+        int64_t t0 = esp_timer_get_time();
+        cb(arg);
+        uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        hist_add(t, us);
+        /* Long callbacks may have let further deadlines pass */
+        wheel_advance(now_tick());
+    }
+    wheel_arm();
+    xSemaphoreGive(s_lock);
+}
+
+void lamp_timer_init(lamp_timer_t *t, const char *name, lamp_timer_cb_t cb, void *arg)
+{
+    *t = (lamp_timer_t){ .name = name, .cb = cb, .arg = arg };
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    t->all_next = s_all;
+    s_all = t;
+    xSemaphoreGive(s_lock);
+}
+
+static void timer_start(lamp_timer_t *t, uint64_t delay_us, uint64_t period_us)
+{
+    uint64_t due_us = (uint64_t)esp_timer_get_time() + delay_us;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (t->pprev) list_del(t);
+    /* Round up: never before the requested time */
+    t->expires = (due_us + LAMP_TIMER_TICK_US - 1) / LAMP_TIMER_TICK_US;
+    if (t->expires <= s_tick) t->expires = s_tick + 1;
+    t->period = 0;
+    if (period_us) {
+        uint64_t ticks = (period_us + LAMP_TIMER_TICK_US / 2) / LAMP_TIMER_TICK_US;
+        t->period = ticks ? (uint32_t)ticks : 1;
+    }
+    wheel_insert(t);
+    wheel_arm();
+    xSemaphoreGive(s_lock);
+}
+
+void lamp_timer_start_once(lamp_timer_t *t, uint64_t delay_us)
+{
+    timer_start(t, delay_us, 0);
+}
+
+void lamp_timer_start_periodic(lamp_timer_t *t, uint64_t period_us)
+{
+    timer_start(t, period_us, period_us);
+}
+
+void lamp_timer_stop(lamp_timer_t *t)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (t->pprev) {
+        list_del(t);
+        wheel_arm();
+    }
+    t->period = 0;
+    xSemaphoreGive(s_lock);
+}
+
+bool lamp_timer_is_active(const lamp_timer_t *t)
+{
+    return t->pprev != NULL;
+}
+
+void lamp_timer_log_stats(void)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ESP_LOGI(TAG, "Wakeups=%lu; callback runtime (bin i counts runs < 16<<i us):",
+             (unsigned long)s_wakeups);
+    for (const lamp_timer_t *t = s_all; t; t = t->all_next) {
+        char line[LAMP_TIMER_HIST_BINS * 11 + 1];
+        int n = 0;
+        for (int i = 0; i < LAMP_TIMER_HIST_BINS; i++) {
+            n += snprintf(line + n, sizeof(line) - n, " %lu", (unsigned long)t->bins[i]);
+        }
+        ESP_LOGI(TAG, "  %-13s runs=%-7lu max=%6luus |%s", t->name,
+                 (unsigned long)t->runs, (unsigned long)t->max_us, line);
+    }
+    xSemaphoreGive(s_lock);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fade engine — timed transitions of the base colour, master brightness and
+ * fade envelope, stepped by a render-task animator at the render rate.
+ *
+ * Colour bytes are already perceptual (gamma is applied at flush), so they
+ * are interpolated directly.  Master and envelope scale light after gamma,
+ * so they are interpolated on the perceptual scale (level^(1/2.2)) and
+ * written back to the compositor as Q16 levels — equal steps look equal
+ * from full brightness down to the dimmest, without the 8-bit master ×
+ * envelope product.  All fixed point.
+ *
+ * Fades on different channels run side by side (e.g. a scene crossfade of
+ * colour and master under an auto envelope fade).  A new fade takes its
+ * channels over from whatever fade held them, starting from the current
+ * output, so a reversal mid-fade is continuous; a fade left with no
+ * channels is dropped without its done callback.  Re-issuing a running
+ * fade (same target, channels and callback) leaves it undisturbed.
+ */
+
+typedef enum {
+    LAMP_EASE_LINEAR,
+    LAMP_EASE_IN,           /* quadratic: slow start */
+    LAMP_EASE_OUT,          /* quadratic: slow finish */
+    LAMP_EASE_IN_OUT,       /* smoothstep */
+} lamp_ease_t;
+
+/* Channels a fade moves; the others keep whatever is set */
+#define LAMP_FADE_COLOR     (1 << 0)    /* base colour, repaints every pixel */
+#define LAMP_FADE_MASTER    (1 << 1)
+#define LAMP_FADE_ENVELOPE  (1 << 2)
+
+typedef struct {
+    uint8_t warm;
+    uint8_t neutral;
+    uint8_t cool;
+    uint8_t master;
+    uint8_t envelope;
+} lamp_fade_level_t;
+
+/**
+ * Fade completion callback.  Runs on the render task after the final frame
+ * has been written (or in the caller for a zero-length fade); may start
+ * another fade.
+ */
+typedef void (*lamp_fade_done_fn_t)(void *arg);
+
+/**
+ * Fade the selected channels from what is showing now to @p to, taking
+ * them over from any fade running on them.
+ * @param channels     LAMP_FADE_* mask.
+ * @param duration_ms  0 applies @p to and flushes immediately.
+ * @param done         Called once the target is reached (optional).
+ * @return ESP_ERR_INVALID_ARG for an empty channel mask.
+ */
+esp_err_t lamp_fade_to(const lamp_fade_level_t *to, uint8_t channels, uint32_t duration_ms,
+                       lamp_ease_t ease, lamp_fade_done_fn_t done, void *arg);
+
+/**
+ * Stop the fades started with @p done and @p arg where they are (every fade
+ * if @p done is NULL).  Their done callbacks are not called.  Once this
+ * returns no further frame of those fades is written.
+ */
+void lamp_fade_stop(lamp_fade_done_fn_t done, void *arg);
+
+/**
+ * Returns true while a fade is moving any of @p channels (LAMP_FADE_* mask).
+ */
+bool lamp_fade_is_running(uint8_t channels);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Render loop — a single task in led_driver owns the frame buffer flush.
+ *
+ * Modes publish state into the frame buffer (lamp_fill / lamp_write_frame /
+ * lamp_set_master) and call lamp_flush() to request an update.  Animated
+ * modes register an animator instead of running their own task or timer:
+ * while at least one animator is registered the render task ticks, runs
+ * every animator, then flushes exactly once.  With no animators it sleeps
+ * until the next lamp_flush() request.
+ *
+ * The tick rate is one of LAMP_RENDER_FPS_MIN, LAMP_RENDER_FPS and
+ * LAMP_RENDER_FPS_MAX.  Each animator states the highest rate it can use
+ * (LAMP_RENDER_FPS unless set with lamp_animator_set_fps()); the render
+ * task runs at the highest of those, stepping down a rate when ticks miss
+ * their deadline or the frame work leaves too little headroom, and back up
+ * once it has run clean for a while (LED_DRIVER_RENDER_ADAPTIVE).
+ * Animators must therefore advance by elapsed time, not per call.
+ */
+
+#define LAMP_RENDER_FPS_MIN 15
+#define LAMP_RENDER_FPS     30      /* default, and the nominal frame of time-scaled params */
+#define LAMP_RENDER_FPS_MAX 60
+
+/**
+ * Animator callback, run on the render task once per tick before the flush.
+ * Writes its output with the lamp_* setters; the render task flushes after
+ * all animators have run.
+ * @param now_us  esp_timer timestamp of this tick.
+ * @param arg     Context pointer passed to lamp_animator_start().
+ * @return true to keep animating, false to unregister.
+ */
+typedef bool (*lamp_animator_fn_t)(int64_t now_us, void *arg);
+
+/**
+ * Register an animator (no-op if already registered).  Ticking starts
+ * immediately.  A start while the animator is returning false keeps it
+ * registered, so it runs again on the next tick.
+ * @return ESP_ERR_NO_MEM if all animator slots are in use.
+ */
+esp_err_t lamp_animator_start(lamp_animator_fn_t fn, void *arg);
+
+/**
+ * Unregister an animator.  When called from outside the render task this
+ * waits for an in-progress invocation of @p fn to return, so the caller
+ * can safely overwrite the frame buffer afterwards.
+ */
+void lamp_animator_stop(lamp_animator_fn_t fn, void *arg);
+
+/**
+ * Returns true if the animator is registered.
+ */
+bool lamp_animator_is_running(lamp_animator_fn_t fn, void *arg);
+
+/**
+ * Set the highest tick rate a registered animator can use — rounded down
+ * to a supported rate and clamped to LAMP_RENDER_FPS_MIN..MAX.  Lower it
+ * for content that barely changes; the render task may still tick slower
+ * under load.  Safe to call from the animator itself.
+ * @return ESP_ERR_NOT_FOUND if the animator is not registered.
+ */
+esp_err_t lamp_animator_set_fps(lamp_animator_fn_t fn, void *arg, uint8_t fps);
+
+/**
+ * Current tick rate, or 0 while no animator is registered.
+ */
+uint8_t lamp_render_get_fps(void);
+
+#ifdef __cplusplus
+}
+#endif
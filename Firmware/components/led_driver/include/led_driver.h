@@ -21,24 +21,71 @@ typedef struct {
     uint8_t row;
 } led_coord_t;
 
+/* Flush counters (monotonic since boot) */
+typedef struct {
+    uint32_t frames;        /* frames packed by the render task */
+    uint32_t dropped;       /* pending frames superseded before the previous TX finished */
+    uint32_t skipped;       /* identical to the last frame sent — not transmitted */
+    uint32_t tx_errors;     /* backend refused to start a transmission */
+} led_driver_stats_t;
+
+/* Timing histogram — bin i counts samples below (16 << i) µs, the last bin
+ * everything above */
+#define LED_HIST_BINS   12
+
+typedef struct {
+    uint32_t bins[LED_HIST_BINS];
+    uint32_t max_us;
+} led_hist_t;
+
+/* Render/flush timing (since boot or the last led_driver_reset_timing()) */
+typedef struct {
+    led_hist_t pack;            /* compose + pack of one frame */
+    led_hist_t lock_wait;       /* render task waiting for the frame buffer mutex */
+    led_hist_t tx;              /* backend transmit start → TX-done ISR */
+    led_hist_t jitter;          /* |tick interval − current period| while animating */
+    uint32_t   missed_ticks;    /* render ticks that started a full period late */
+    uint32_t   rate_changes;    /* adaptive render rate steps (lamp_render.h) */
+} led_timing_t;
+
 /* Physical position of each LED (0-indexed, D1=index 0) */
 extern const led_coord_t led_coords[LED_COUNT];
 
 /**
- * Initialise the RMT TX channel for SK6812WWA on LED_GPIO.
+ * Initialise the LED output backend (RMT or SPI DMA, see Kconfig) for
+ * SK6812WWA on LED_GPIO.
  */
 esp_err_t led_driver_init(void);
 
+/*
+ * Compositor — the frame is built from layers at flush time:
+ *
+ *   base    lamp_fill / lamp_set_pixel / lamp_write_frame  (colour per pixel)
+ *   effect  lamp_set_effect      per-pixel intensity, multiplies the base
+ *   master  lamp_set_master      scene brightness   } applied after gamma
+ *   fade    lamp_set_fade        envelope (auto)    }
+ *   overlay lamp_set_overlay     uniform colour blended on top, unaffected
+ *                                by master/fade (e.g. pairing blink)
+ *
+ * Layer setters only update state; call lamp_flush() to show the result.
+ */
+
 /**
- * Set a single pixel in the frame buffer (does not transmit).
+ * Set a single pixel in the base layer (does not transmit).
  */
 void lamp_set_pixel(uint8_t index, uint8_t warm, uint8_t neutral, uint8_t cool);
 
 /**
- * Fill all pixels with the same colour (does not transmit).
+ * Fill the base layer with one colour (does not transmit).
  */
 void lamp_fill(uint8_t warm, uint8_t neutral, uint8_t cool);
 
+/**
+ * Replace the whole base layer (LED_COUNT pixels, index 0 = D1; does not
+ * transmit).
+ */
+void lamp_set_pixels(const led_pixel_t *frame);
+
 /**
  * Set the master brightness scaler (0–255).  Applied at flush time.
  */
@@ -50,18 +97,77 @@ void lamp_set_master(uint8_t brightness);
 uint8_t lamp_get_master(void);
 
 /**
- * Read back a pixel from the frame buffer.
+ * Set the fade envelope (0–255, default 255).  Multiplies master brightness.
+ */
+void lamp_set_fade(uint8_t level);
+
+/**
+ * Get the current fade envelope.
+ */
+uint8_t lamp_get_fade(void);
+
+/**
+ * Set the effect intensity map (LED_COUNT values, 255 = base colour at full).
+ * Pass NULL to remove the effect layer.
+ */
+void lamp_set_effect(const uint8_t *intensity);
+
+/**
+ * Set the overlay colour and opacity (alpha 0 = no overlay).
+ */
+void lamp_set_overlay(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t alpha);
+
+/**
+ * Read back a pixel from the base layer.
  */
 void lamp_get_pixel(uint8_t index, led_pixel_t *out);
 
 /**
- * Apply master brightness + gamma correction and transmit the frame buffer
- * to the LED strip via RMT.
+ * Request a flush of the composed frame to the LED strip.
+ *
+ * Non-blocking: the render task (see lamp_render.h) composes the layers,
+ * packs the frame into the back TX buffer and hands it to the backend.
+ * While animators are running, requests are coalesced into the next render
+ * tick; otherwise the render task flushes straight away.  If the previous
+ * frame is still on the wire the new one is held as pending and sent from
+ * the TX-done path; a pending frame that is superseded before it goes out
+ * is counted as dropped.  A frame byte-identical to the last one sent is
+ * skipped, except for a periodic forced refresh (CONFIG_LED_DRIVER_REFRESH_S),
+ * which the render task also sends when nothing has been flushed since.
  */
 void lamp_flush(void);
 
 /**
- * Turn all LEDs off immediately (fill black + flush).
+ * Replace the whole base layer, set the master brightness and request a
+ * flush, all under a single lock acquisition.  A frame written this way is never
+ * interleaved with other writers (e.g. a lamp_fill() from the BLE task).
+ * @param frame   LED_COUNT pixels, index 0 = D1.
+ * @param master  Master brightness (0–255).
+ */
+void lamp_write_frame(const led_pixel_t *frame, uint8_t master);
+
+/**
+ * Read the flush counters.
+ */
+void led_driver_get_stats(led_driver_stats_t *out);
+
+/**
+ * Read the render/flush timing histograms.
+ */
+void led_driver_get_timing(led_timing_t *out);
+
+/**
+ * Clear the timing histograms (flush counters are left untouched).
+ */
+void led_driver_reset_timing(void);
+
+/**
+ * Log the flush counters and timing histograms at INFO level.
+ */
+void led_driver_log_timing(void);
+
+/**
+ * Turn all LEDs off (fill black + flush request).
  */
 void lamp_off(void);
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LED output backend — clocks packed SK6812WWA frames out on LED_GPIO.
+ * Exactly one implementation is linked, selected by CONFIG_LED_DRIVER_BACKEND_*.
+ */
+
+/**
+ * TX completion callback, invoked from ISR context once a frame (including
+ * the >= 80 us latch gap) has been fully clocked out.
+ * @return true if a higher-priority task was woken.
+ */
+typedef bool (*led_backend_done_cb_t)(void);
+
+/**
+ * Initialise the output peripheral.
+ * @param on_done  Called from ISR context when each transmission completes.
+ */
+esp_err_t led_backend_init(led_backend_done_cb_t on_done);
+
+/**
+ * Start clocking out a packed frame (3 bytes per LED: [cool, warm, neutral]).
+ * Non-blocking.  Only called while no other transmission is in flight; @p data
+ * must stay untouched until @p on_done fires.
+ */
+esp_err_t led_backend_transmit(const uint8_t *data, size_t len);
+
+/**
+ * Enable or disable the output peripheral between transmissions (power
+ * management builds).  A disabled peripheral drops its PM lock so the chip
+ * can light-sleep; the line idles low and the LEDs keep the last frame.
+ * Only called while no transmission is in flight.
+ */
+esp_err_t led_backend_set_enabled(bool enabled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "led_driver.h"
+#include "led_backend.h"
+
+static const char *TAG = "led_capture";
+
+/*
+ * Frame capture backend (linux target).  Trace format, all little-endian:
+ *
+ *   header   "LEDT"  version:u16  led_count:u16  bytes_per_led:u8  reserved:u8
+ *   layout   led_count × [col:u8, row:u8]           (led_coords order)
+ *   records  timestamp_us:u64  len:u16  data[len]   ([cool, warm, neutral] per LED)
+ *
+ * Records are written exactly as they would be clocked out, i.e. after the
+ * compositor, gamma and master.  Tools/led_trace.py renders them.
+ */
+
+#define TRACE_MAGIC     "LEDT"
+#define TRACE_VERSION   1
+
+static FILE                 *s_file;
+static led_backend_done_cb_t s_on_done;
+
+static void put_le(uint8_t *p, uint64_t v, int n)
+{
+    for (int i = 0; i < n; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+esp_err_t led_backend_init(led_backend_done_cb_t on_done)
+{
+    s_on_done = on_done;
+
+    const char *path = getenv("LED_TRACE");
+    if (!path || !path[0]) path = CONFIG_LED_DRIVER_CAPTURE_PATH;
+    s_file = fopen(path, "wb");
+    ESP_RETURN_ON_FALSE(s_file, ESP_FAIL, TAG, "cannot open trace file %s", path);
+
+    uint8_t hdr[10];
+    memcpy(hdr, TRACE_MAGIC, 4);
+    put_le(&hdr[4], TRACE_VERSION, 2);
+    put_le(&hdr[6], LED_COUNT, 2);
+    hdr[8] = 3;
+    hdr[9] = 0;
+    fwrite(hdr, 1, sizeof(hdr), s_file);
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint8_t xy[2] = { led_coords[i].col, led_coords[i].row };
+        fwrite(xy, 1, sizeof(xy), s_file);
+    }
+    fflush(s_file);
+
+    ESP_LOGI(TAG, "Capturing LED frames to %s", path);
+    return ESP_OK;
+}
+
+esp_err_t led_backend_transmit(const uint8_t *data, size_t len)
+{
+    ESP_RETURN_ON_FALSE(s_file, ESP_ERR_INVALID_STATE, TAG, "not initialised");
+
+    uint8_t rec[10];
+    put_le(&rec[0], (uint64_t)esp_timer_get_time(), 8);
+    put_le(&rec[8], len, 2);
+    if (fwrite(rec, 1, sizeof(rec), s_file) != sizeof(rec) ||
+        fwrite(data, 1, len, s_file) != len) {
+        return ESP_FAIL;
+    }
+    fflush(s_file);
+
+    /* No wire time to wait for — complete immediately */
+    s_on_done();
+    return ESP_OK;
+}
+
+esp_err_t led_backend_set_enabled(bool enabled)
+{
+    return ESP_OK;
+}
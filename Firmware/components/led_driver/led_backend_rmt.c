@@ -0,0 +1,101 @@
+#include "sdkconfig.h"
+#include "driver/rmt_tx.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "led_driver.h"
+#include "led_backend.h"
+#include "led_encoder.h"
+
+static const char *TAG = "led_rmt";
+
+/* RMT resolution: 10 MHz (100 ns per tick) */
+#define RMT_RESOLUTION_HZ   10000000
+
+/* Channel memory is allocated in 64-symbol blocks: round the Kconfig value
+ * down rather than let rmt_new_tx_channel() round it up behind our back */
+#define RMT_MEM_SYMBOLS     (CONFIG_LED_DRIVER_RMT_MEM_SYMBOLS & ~63)
+
+static rmt_channel_handle_t  s_rmt_chan;
+static rmt_encoder_handle_t  s_encoder;
+static led_backend_done_cb_t s_on_done;
+
+#if CONFIG_LED_DRIVER_RMT_ENCODER_TABLE
+#define ENCODER_NAME        "table"
+#else
+#define ENCODER_NAME        "bytes"
+#endif
+
+#if CONFIG_LED_DRIVER_RMT_ENCODE_STATS
+#define ENC_STATS_FRAMES    300
+static uint32_t s_tx_count;
+#endif
+
+static bool IRAM_ATTR rmt_done_cb(rmt_channel_handle_t chan,
+                                  const rmt_tx_done_event_data_t *edata, void *ctx)
+{
+    return s_on_done();
+}
+
+esp_err_t led_backend_init(led_backend_done_cb_t on_done)
+{
+    s_on_done = on_done;
+
+    /* Configure RMT TX channel.
+     * 31 LEDs × 3 bytes × 8 bits = 744 RMT symbols per frame.
+     * With small mem_block_symbols the RMT driver uses ping-pong ISR
+     * refill — if a BLE interrupt delays a refill past the point where
+     * the half being played drains, the LEDs see a false reset pulse
+     * mid-frame, shifting byte alignment and causing colour channel
+     * corruption (warm data appears as cool).  The default 384 symbols
+     * (6 blocks) rides out BLE latency; the table encoder's refill is a
+     * straight copy and may allow 256 (128 symbols ≈ 150 µs per half)
+     * once its ISR stats are measured under radio load.
+     * CONFIG_LED_DRIVER_BACKEND_SPI avoids the refill ISR altogether. */
+    rmt_tx_channel_config_t tx_cfg = {
+        .gpio_num           = LED_GPIO,
+        .clk_src            = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz      = RMT_RESOLUTION_HZ,
+        .mem_block_symbols   = RMT_MEM_SYMBOLS,
+        .trans_queue_depth   = 2,   /* rmt_transmit() never waits on the driver queue */
+    };
+    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_cfg, &s_rmt_chan), TAG, "RMT TX init failed");
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = rmt_done_cb,
+    };
+    ESP_RETURN_ON_ERROR(rmt_tx_register_event_callbacks(s_rmt_chan, &cbs, NULL),
+                        TAG, "RMT callback register failed");
+    ESP_RETURN_ON_ERROR(rmt_enable(s_rmt_chan), TAG, "RMT enable failed");
+
+    /* Create the SK6812 encoder */
+    ESP_RETURN_ON_ERROR(sk6812_encoder_new(&s_encoder), TAG, "encoder create failed");
+
+    ESP_LOGI(TAG, "RMT backend on GPIO %d (%d symbols, %s encoder)", LED_GPIO,
+             RMT_MEM_SYMBOLS, ENCODER_NAME);
+    return ESP_OK;
+}
+
+esp_err_t led_backend_transmit(const uint8_t *data, size_t len)
+{
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+#if CONFIG_LED_DRIVER_RMT_ENCODE_STATS
+    if (++s_tx_count % ENC_STATS_FRAMES == 0) {
+        sk6812_encoder_stats_t st;
+        sk6812_encoder_get_stats(&st, true);
+        ESP_LOGI(TAG, "Encoder: %lu calls, avg %lu / max %lu cycles per call",
+                 (unsigned long)st.calls,
+                 (unsigned long)(st.calls ? st.total_cycles / st.calls : 0),
+                 (unsigned long)st.max_cycles);
+    }
+#endif
+    return rmt_transmit(s_rmt_chan, s_encoder, data, len, &tx_config);
+}
+
+esp_err_t led_backend_set_enabled(bool enabled)
+{
+    /* An enabled channel holds the driver's APB_FREQ_MAX lock */
+    return enabled ? rmt_enable(s_rmt_chan) : rmt_disable(s_rmt_chan);
+}
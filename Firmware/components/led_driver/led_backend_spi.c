@@ -0,0 +1,119 @@
+#include <string.h>
+#include "driver/spi_master.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "led_driver.h"
+#include "led_backend.h"
+
+static const char *TAG = "led_spi";
+
+/*
+ * SK6812 NZR waveform generated by SPI MOSI + DMA.
+ *
+ * Each LED bit is sent as 4 SPI bits at 3.2 MHz (312.5 ns per SPI bit):
+ *   bit 0 → 1000   T0H = 312 ns   T0L = 938 ns
+ *   bit 1 → 1100   T1H = 625 ns   T1L = 625 ns
+ * so one data byte expands to 4 SPI bytes.  The whole frame plus the
+ * >= 80 us low latch gap is pre-encoded into a DMA buffer and clocked out
+ * without any CPU involvement or refill ISR — BLE/WiFi interrupt latency
+ * cannot stretch a bit mid-frame.
+ */
+
+#define SPI_LED_HOST        SPI2_HOST
+#define SPI_LED_CLOCK_HZ    3200000     /* 80 MHz APB / 25 */
+#define SPI_BYTES_PER_BYTE  4
+#define SPI_RESET_BYTES     40          /* 40 × 8 × 312.5 ns = 100 us low */
+#define SPI_FRAME_BYTES     (LED_COUNT * 3 * SPI_BYTES_PER_BYTE + SPI_RESET_BYTES)
+
+/* 4 data bits (MSB first) → 16 SPI bits */
+static const uint16_t s_nibble_lut[16] = {
+    0x8888, 0x888C, 0x88C8, 0x88CC, 0x8C88, 0x8C8C, 0x8CC8, 0x8CCC,
+    0xC888, 0xC88C, 0xC8C8, 0xC8CC, 0xCC88, 0xCC8C, 0xCCC8, 0xCCCC,
+};
+
+static spi_device_handle_t   s_spi;
+static uint8_t              *s_dma_buf;
+static spi_transaction_t     s_trans;
+static bool                  s_trans_queued;
+static led_backend_done_cb_t s_on_done;
+
+static void IRAM_ATTR spi_post_cb(spi_transaction_t *trans)
+{
+    if (s_on_done()) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+esp_err_t led_backend_init(led_backend_done_cb_t on_done)
+{
+    s_on_done = on_done;
+
+    s_dma_buf = heap_caps_calloc(1, SPI_FRAME_BYTES, MALLOC_CAP_DMA);
+    ESP_RETURN_ON_FALSE(s_dma_buf, ESP_ERR_NO_MEM, TAG, "no DMA memory");
+
+    spi_bus_config_t bus_cfg = {
+        .mosi_io_num     = LED_GPIO,
+        .miso_io_num     = -1,
+        .sclk_io_num     = -1,
+        .quadwp_io_num   = -1,
+        .quadhd_io_num   = -1,
+        .max_transfer_sz = SPI_FRAME_BYTES,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_initialize(SPI_LED_HOST, &bus_cfg, SPI_DMA_CH_AUTO),
+                        TAG, "SPI bus init failed");
+
+    spi_device_interface_config_t dev_cfg = {
+        .clock_speed_hz = SPI_LED_CLOCK_HZ,
+        .mode           = 0,
+        .spics_io_num   = -1,
+        .queue_size     = 2,
+        .post_cb        = spi_post_cb,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_add_device(SPI_LED_HOST, &dev_cfg, &s_spi),
+                        TAG, "SPI device add failed");
+
+    ESP_LOGI(TAG, "SPI DMA backend on GPIO %d (%d bytes/frame)", LED_GPIO, SPI_FRAME_BYTES);
+    return ESP_OK;
+}
+
+esp_err_t led_backend_transmit(const uint8_t *data, size_t len)
+{
+    if (len * SPI_BYTES_PER_BYTE + SPI_RESET_BYTES > SPI_FRAME_BYTES) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    /* Reap the previous transaction so the driver's result queue never fills.
+     * The caller guarantees it has already completed. */
+    if (s_trans_queued) {
+        spi_transaction_t *done;
+        spi_device_get_trans_result(s_spi, &done, 0);
+        s_trans_queued = false;
+    }
+
+    uint8_t *out = s_dma_buf;
+    for (size_t i = 0; i < len; i++) {
+        uint16_t hi = s_nibble_lut[data[i] >> 4];
+        uint16_t lo = s_nibble_lut[data[i] & 0x0F];
+        *out++ = hi >> 8;
+        *out++ = hi & 0xFF;
+        *out++ = lo >> 8;
+        *out++ = lo & 0xFF;
+    }
+    memset(out, 0, SPI_RESET_BYTES);   /* latch gap */
+
+    s_trans = (spi_transaction_t){
+        .length    = (len * SPI_BYTES_PER_BYTE + SPI_RESET_BYTES) * 8,
+        .tx_buffer = s_dma_buf,
+    };
+    esp_err_t ret = spi_device_queue_trans(s_spi, &s_trans, 0);
+    if (ret == ESP_OK) s_trans_queued = true;
+    return ret;
+}
+
+esp_err_t led_backend_set_enabled(bool enabled)
+{
+    /* The SPI master only holds its PM lock while a transaction is queued */
+    return ESP_OK;
+}
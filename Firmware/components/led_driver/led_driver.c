@@ -1,57 +1,246 @@
+#include <stdio.h>
 #include <string.h>
+#include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "freertos/semphr.h"
-#include "driver/rmt_tx.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
+#if CONFIG_LED_DRIVER_PACK_BENCH
+#include "esp_cpu.h"
+#endif
 
 #include "led_driver.h"
-#include "led_encoder.h"
+#include "led_backend.h"
 #include "led_gamma.h"
+#include "led_internal.h"
+#include "lamp_render.h"
+#include "lamp_fade.h"
 
 static const char *TAG = "led_drv";
 
-/* RMT resolution: 10 MHz (100 ns per tick) */
-#define RMT_RESOLUTION_HZ   10000000
-
 /* Internal state */
-static led_pixel_t        s_framebuf[LED_COUNT];
-static uint8_t            s_master = 255;
+/* Compositor layers, combined at flush time:
+ *   out = blend(gamma(base × effect) × master × fade, overlay, alpha)
+ * base and effect are pre-gamma so intensity maps see full-range values;
+ * master and fade are applied after gamma through the combined LUT.  Both
+ * are Q16 (GAMMA_LEVEL_FULL = 1.0) so the fade engine (led_fade.c) can move
+ * them in steps finer than the byte setters. */
+static led_pixel_t        s_framebuf[LED_COUNT];     /* base colour */
+static uint8_t            s_effect[LED_COUNT];       /* per-pixel intensity */
+static bool               s_effect_on;
+static uint32_t           s_master = GAMMA_LEVEL_FULL;   /* scene brightness */
+static uint32_t           s_fade   = GAMMA_LEVEL_FULL;   /* fade envelope */
+static uint8_t            s_overlay_tx[3];           /* gamma-corrected [cool, warm, neutral] */
+static uint8_t            s_overlay_alpha;
 static SemaphoreHandle_t  s_mutex;
-static rmt_channel_handle_t s_rmt_chan;
-static rmt_encoder_handle_t s_encoder;
+static bool               s_flush_req;     /* lamp_flush() since the last render flush */
+
+/* TX buffers: 3 bytes per LED [cool, warm, neutral] — SK6812WWA 24-bit protocol.
+ * Front/back pair: the backend streams the front buffer while lamp_flush()
+ * packs the next frame into the back buffer. */
+static uint8_t s_tx_buf[2][LED_COUNT * 3];
+static int     s_tx_back;                  /* index of the buffer being packed */
+
+/* TX state shared with the backend done ISR — guarded by s_tx_lock */
+static portMUX_TYPE s_tx_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool         s_tx_in_flight;        /* front buffer is on the wire */
+static bool         s_tx_pending;          /* back buffer holds an unsent frame */
+
+/* Last frame handed to the backend (or left pending) — for change detection */
+static uint8_t    s_last_tx[LED_COUNT * 3];
+static bool       s_last_tx_valid;
+static TickType_t s_last_tx_tick;
+
+#define REFRESH_TICKS   pdMS_TO_TICKS(CONFIG_LED_DRIVER_REFRESH_S * 1000)
+
+#if CONFIG_PM_ENABLE
+static bool       s_backend_on = true;     /* led_backend_init() leaves it enabled */
+#endif
+
+static led_driver_stats_t s_stats;
+
+/* Timing: tx is written from the TX-done ISR under s_tx_lock, the rest by the
+ * render task under s_mutex */
+static led_timing_t s_timing;
+static int64_t      s_tx_start_us;
+
+static void tx_start_locked(void);
+
+/* Runs on the render task, woken by the TX-done ISR */
+void led_driver_service_tx(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&s_tx_lock);
+    bool start = s_tx_pending && !s_tx_in_flight;
+    if (start) {
+        s_tx_pending   = false;
+        s_tx_in_flight = true;
+    }
+    taskEXIT_CRITICAL(&s_tx_lock);
+    if (start) tx_start_locked();
+    xSemaphoreGive(s_mutex);
+}
 
-/* TX buffer: 3 bytes per LED [cool, warm, neutral] — SK6812WWA 24-bit protocol */
-static uint8_t s_tx_buf[LED_COUNT * 3];
+bool led_driver_release_backend(void)
+{
+#if CONFIG_PM_ENABLE
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&s_tx_lock);
+    bool idle = !s_tx_in_flight && !s_tx_pending;
+    taskEXIT_CRITICAL(&s_tx_lock);
+    if (idle && s_backend_on && led_backend_set_enabled(false) == ESP_OK) {
+        s_backend_on = false;
+    }
+    xSemaphoreGive(s_mutex);
+    return idle;
+#else
+    return true;
+#endif
+}
+
+static inline void IRAM_ATTR hist_add(led_hist_t *h, uint32_t us)
+{
+    /* Bin i holds [16 << (i-1), 16 << i) µs: log2 via count-leading-zeros */
+    int bin = (us < 16) ? 0 : (32 - __builtin_clz(us)) - 4;
+    if (bin >= LED_HIST_BINS) bin = LED_HIST_BINS - 1;
+    h->bins[bin]++;
+    if (us > h->max_us) h->max_us = us;
+}
+
+static bool IRAM_ATTR tx_done_cb(void)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL_ISR(&s_tx_lock);
+    hist_add(&s_timing.tx, (uint32_t)(now - s_tx_start_us));
+    s_tx_in_flight = false;
+    bool pending = s_tx_pending;
+    taskEXIT_CRITICAL_ISR(&s_tx_lock);
+
+    /* Backend transmit is not ISR-safe — hand the pending frame to the render task */
+    return pending ? led_render_kick_from_isr() : false;
+}
+
+/* Byte (0–255) ↔ Q16 level, exact at both ends */
+static inline uint32_t level_from_u8(uint8_t v)
+{
+    return ((uint32_t)v * GAMMA_LEVEL_FULL + 127) / 255;
+}
+
+static inline uint8_t level_to_u8(uint32_t level)
+{
+    return (uint8_t)((level * 255 + GAMMA_LEVEL_FULL / 2) >> 16);
+}
+
+/* master × fade, Q16 */
+static inline uint32_t brightness(void)
+{
+    return (uint32_t)(((uint64_t)s_master * s_fade + GAMMA_LEVEL_FULL / 2) >> 16);
+}
+
+/* a × b / 255, exact at b = 0 and b = 255 */
+static inline uint8_t mul8(uint8_t a, uint8_t b)
+{
+    return ((uint16_t)a * b + 255) >> 8;
+}
+
+/* Apply the combined gamma × master table: three loads and three stores
+ * per pixel.  SK6812WWA byte order: [cool, warm, neutral] */
+static inline void pack_frame(uint8_t *tx, const led_pixel_t *fb, const uint8_t *lut)
+{
+    for (int i = 0; i < LED_COUNT; i++) {
+        tx[i * 3 + 0] = lut[fb[i].cool];
+        tx[i * 3 + 1] = lut[fb[i].warm];
+        tx[i * 3 + 2] = lut[fb[i].neutral];
+    }
+}
+
+/* Full layer stack in one pass.  Falls back to pack_frame() when neither
+ * an effect map nor an overlay is active.  Caller holds s_mutex. */
+static void compose_frame(uint8_t *tx)
+{
+    gamma_set_level(brightness());
+    const uint8_t *lut = gamma_master_table();
+
+    if (!s_effect_on && s_overlay_alpha == 0) {
+        pack_frame(tx, s_framebuf, lut);
+        return;
+    }
+
+    const uint8_t a  = s_overlay_alpha;
+    const uint8_t ia = 255 - a;
+    const uint16_t o0 = (uint16_t)s_overlay_tx[0] * a;
+    const uint16_t o1 = (uint16_t)s_overlay_tx[1] * a;
+    const uint16_t o2 = (uint16_t)s_overlay_tx[2] * a;
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint8_t e = s_effect_on ? s_effect[i] : 255;
+        tx[i * 3 + 0] = ((uint16_t)lut[mul8(s_framebuf[i].cool,    e)] * ia + o0 + 255) >> 8;
+        tx[i * 3 + 1] = ((uint16_t)lut[mul8(s_framebuf[i].warm,    e)] * ia + o1 + 255) >> 8;
+        tx[i * 3 + 2] = ((uint16_t)lut[mul8(s_framebuf[i].neutral, e)] * ia + o2 + 255) >> 8;
+    }
+}
+
+#if CONFIG_LED_DRIVER_PACK_BENCH
+/* Previous pack loop: per-channel gamma lookup, multiply and divide */
+static void pack_frame_legacy(uint8_t *tx, const led_pixel_t *fb, uint8_t master)
+{
+    for (int i = 0; i < LED_COUNT; i++) {
+        tx[i * 3 + 0] = (uint16_t)gamma_correct(fb[i].cool)    * master / 255;
+        tx[i * 3 + 1] = (uint16_t)gamma_correct(fb[i].warm)    * master / 255;
+        tx[i * 3 + 2] = (uint16_t)gamma_correct(fb[i].neutral) * master / 255;
+    }
+}
+
+#define PACK_BENCH_ITERS    1000
+
+static void pack_bench(void)
+{
+    static led_pixel_t fb[LED_COUNT];
+    static uint8_t     out[LED_COUNT * 3];
+    for (int i = 0; i < LED_COUNT; i++) {
+        fb[i] = (led_pixel_t){ (uint8_t)(i * 8), (uint8_t)(255 - i * 8), (uint8_t)(i * 3) };
+    }
+    uint8_t master = 200;
+
+    esp_cpu_cycle_count_t t0 = esp_cpu_get_cycle_count();
+    for (int n = 0; n < PACK_BENCH_ITERS; n++) {
+        pack_frame_legacy(out, fb, master);
+    }
+    esp_cpu_cycle_count_t t1 = esp_cpu_get_cycle_count();
+
+    gamma_set_level(level_from_u8(master));
+    const uint8_t *lut = gamma_master_table();
+    esp_cpu_cycle_count_t t2 = esp_cpu_get_cycle_count();
+    for (int n = 0; n < PACK_BENCH_ITERS; n++) {
+        pack_frame(out, fb, lut);
+    }
+    esp_cpu_cycle_count_t t3 = esp_cpu_get_cycle_count();
+    gamma_set_level(brightness());
+
+    ESP_LOGI(TAG, "Pack bench (%d frames): legacy=%lu cyc/frame, lut=%lu cyc/frame",
+             PACK_BENCH_ITERS, (unsigned long)((t1 - t0) / PACK_BENCH_ITERS),
+             (unsigned long)((t3 - t2) / PACK_BENCH_ITERS));
+}
+#endif
 
 esp_err_t led_driver_init(void)
 {
     s_mutex = xSemaphoreCreateMutex();
     ESP_RETURN_ON_FALSE(s_mutex, ESP_ERR_NO_MEM, TAG, "mutex create failed");
 
-    /* Configure RMT TX channel.
-     * 31 LEDs × 3 bytes × 8 bits = 744 RMT symbols per frame.
-     * With small mem_block_symbols the RMT driver uses ping-pong ISR
-     * refill — if a BLE interrupt delays a refill by >80 µs, the LEDs
-     * see a false reset pulse mid-frame, shifting byte alignment and
-     * causing colour channel corruption (warm data appears as cool).
-     * Use 384 symbols (6 blocks) so each ping-pong half is 192 symbols
-     * (~230 µs of data) — much more tolerant of ISR latency. */
-    rmt_tx_channel_config_t tx_cfg = {
-        .gpio_num           = LED_GPIO,
-        .clk_src            = RMT_CLK_SRC_DEFAULT,
-        .resolution_hz      = RMT_RESOLUTION_HZ,
-        .mem_block_symbols   = 384,
-        .trans_queue_depth   = 1,
-    };
-    ESP_RETURN_ON_ERROR(rmt_new_tx_channel(&tx_cfg, &s_rmt_chan), TAG, "RMT TX init failed");
-    ESP_RETURN_ON_ERROR(rmt_enable(s_rmt_chan), TAG, "RMT enable failed");
-
-    /* Create the SK6812 encoder */
-    ESP_RETURN_ON_ERROR(sk6812_encoder_new(&s_encoder), TAG, "encoder create failed");
+    ESP_RETURN_ON_ERROR(led_backend_init(tx_done_cb), TAG, "LED backend init failed");
 
     /* Start with all LEDs off */
     memset(s_framebuf, 0, sizeof(s_framebuf));
+    gamma_set_level(brightness());
+
+#if CONFIG_LED_DRIVER_PACK_BENCH
+    pack_bench();
+#endif
+
+    ESP_RETURN_ON_ERROR(led_fade_init(), TAG, "fade engine init failed");
+    ESP_RETURN_ON_ERROR(led_render_init(), TAG, "render task init failed");
 
     ESP_LOGI(TAG, "LED driver initialised: %d LEDs on GPIO %d", LED_COUNT, LED_GPIO);
     return ESP_OK;
@@ -78,16 +267,77 @@ void lamp_fill(uint8_t warm, uint8_t neutral, uint8_t cool)
     xSemaphoreGive(s_mutex);
 }
 
+void lamp_set_pixels(const led_pixel_t *frame)
+{
+    if (!frame) return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(s_framebuf, frame, sizeof(s_framebuf));
+    xSemaphoreGive(s_mutex);
+}
+
 void lamp_set_master(uint8_t brightness)
 {
     xSemaphoreTake(s_mutex, portMAX_DELAY);
-    s_master = brightness;
+    s_master = level_from_u8(brightness);
     xSemaphoreGive(s_mutex);
 }
 
 uint8_t lamp_get_master(void)
 {
-    return s_master;
+    return level_to_u8(s_master);
+}
+
+void lamp_set_fade(uint8_t level)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_fade = level_from_u8(level);
+    xSemaphoreGive(s_mutex);
+}
+
+uint8_t lamp_get_fade(void)
+{
+    return level_to_u8(s_fade);
+}
+
+void led_driver_get_levels(uint32_t *master, uint32_t *fade, led_pixel_t *color)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *master = s_master;
+    *fade   = s_fade;
+    *color  = s_framebuf[0];
+    xSemaphoreGive(s_mutex);
+}
+
+void led_driver_set_levels(uint8_t channels, uint32_t master, uint32_t fade)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (channels & LAMP_FADE_MASTER) {
+        s_master = master < GAMMA_LEVEL_FULL ? master : GAMMA_LEVEL_FULL;
+    }
+    if (channels & LAMP_FADE_ENVELOPE) {
+        s_fade = fade < GAMMA_LEVEL_FULL ? fade : GAMMA_LEVEL_FULL;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void lamp_set_effect(const uint8_t *intensity)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (intensity) {
+        memcpy(s_effect, intensity, sizeof(s_effect));
+    }
+    s_effect_on = (intensity != NULL);
+    xSemaphoreGive(s_mutex);
+}
+
+void lamp_set_overlay(uint8_t warm, uint8_t neutral, uint8_t cool, uint8_t alpha)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_overlay_tx[0] = gamma_correct(cool);
+    s_overlay_tx[1] = gamma_correct(warm);
+    s_overlay_tx[2] = gamma_correct(neutral);
+    s_overlay_alpha = alpha;
+    xSemaphoreGive(s_mutex);
 }
 
 void lamp_get_pixel(uint8_t index, led_pixel_t *out)
@@ -98,36 +348,202 @@ void lamp_get_pixel(uint8_t index, led_pixel_t *out)
     xSemaphoreGive(s_mutex);
 }
 
-/* Rate-limited anomaly counter for flush diagnostics */
-static int s_flush_anomaly_cooldown = 0;
+/* Hand the back buffer to the backend and swap.  Caller holds s_mutex and
+ * has set s_tx_in_flight under s_tx_lock. */
+static void tx_start_locked(void)
+{
+    esp_err_t ret = ESP_OK;
+#if CONFIG_PM_ENABLE
+    if (!s_backend_on) {
+        ret = led_backend_set_enabled(true);
+        s_backend_on = (ret == ESP_OK);
+    }
+#endif
+    s_tx_start_us = esp_timer_get_time();
+    if (ret == ESP_OK) ret = led_backend_transmit(s_tx_buf[s_tx_back], sizeof(s_tx_buf[0]));
+    if (ret != ESP_OK) {
+        taskENTER_CRITICAL(&s_tx_lock);
+        s_tx_in_flight = false;
+        taskEXIT_CRITICAL(&s_tx_lock);
+        /* s_last_tx never reached the strip: don't skip its next flush */
+        s_last_tx_valid = false;
+        s_stats.tx_errors++;
+        ESP_LOGW(TAG, "LED transmit failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    s_tx_back ^= 1;
+}
+
+/* Ticks until the last frame sent is due for its forced refresh (0 = due,
+ * portMAX_DELAY = never).  Caller holds s_mutex. */
+static TickType_t refresh_wait_locked(TickType_t now)
+{
+#if CONFIG_LED_DRIVER_REFRESH_S > 0
+    if (!s_last_tx_valid) return portMAX_DELAY;
+    TickType_t age = now - s_last_tx_tick;
+    return age >= REFRESH_TICKS ? 0 : REFRESH_TICKS - age;
+#else
+    return portMAX_DELAY;
+#endif
+}
+
+/* Pack and send the current frame buffer.  Caller holds s_mutex. */
+static void flush_locked(void)
+{
+    /* Compose the layers into the back buffer.  The back buffer is never
+     * referenced by the backend: it is either idle or holds a pending frame
+     * that has not been handed over yet. */
+    uint8_t *tx = s_tx_buf[s_tx_back];
+    int64_t t0 = esp_timer_get_time();
+    compose_frame(tx);
+    hist_add(&s_timing.pack, (uint32_t)(esp_timer_get_time() - t0));
+    s_stats.frames++;
+
+    /* Skip the transmit if the packed frame is byte-identical to the last one
+     * sent — static scenes, circadian ticks and sync retries re-flush the same
+     * frame.  A periodic forced refresh still repaints the strip in case an
+     * ESD glitch latched garbage into an LED. */
+    TickType_t now = xTaskGetTickCount();
+    if (s_last_tx_valid && memcmp(tx, s_last_tx, sizeof(s_last_tx)) == 0) {
+        if (refresh_wait_locked(now) > 0) {
+            s_stats.skipped++;
+            return;
+        }
+    }
+    memcpy(s_last_tx, tx, sizeof(s_last_tx));
+    s_last_tx_valid = true;
+    s_last_tx_tick  = now;
+
+    /* Send now if the line is idle; otherwise leave it pending for the
+     * TX-done ISR to pick up.  The caller never waits for wire time. */
+    taskENTER_CRITICAL(&s_tx_lock);
+    bool start = !s_tx_in_flight;
+    if (start) {
+        s_tx_in_flight = true;
+        s_tx_pending   = false;     /* this frame supersedes any pending one */
+    } else {
+        if (s_tx_pending) s_stats.dropped++;
+        s_tx_pending = true;
+    }
+    taskEXIT_CRITICAL(&s_tx_lock);
+    if (start) tx_start_locked();
+}
+
+void led_driver_render_flush(void)
+{
+    int64_t t0 = esp_timer_get_time();
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    hist_add(&s_timing.lock_wait, (uint32_t)(esp_timer_get_time() - t0));
+    /* Nothing flushed since the last frame went out: still repaint it when
+     * its forced refresh is due */
+    if (s_flush_req || refresh_wait_locked(xTaskGetTickCount()) == 0) {
+        s_flush_req = false;
+        flush_locked();
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+TickType_t led_driver_refresh_wait(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    TickType_t wait = refresh_wait_locked(xTaskGetTickCount());
+    xSemaphoreGive(s_mutex);
+    return wait;
+}
 
 void lamp_flush(void)
 {
-    /* Copy framebuffer and apply master brightness + gamma under lock */
     xSemaphoreTake(s_mutex, portMAX_DELAY);
-    uint8_t master = s_master;
-    for (int i = 0; i < LED_COUNT; i++) {
-        /* Gamma correct first, then scale by master — avoids crushing
-         * low values into the gamma dead zone at low brightness */
-        uint8_t w = (uint16_t)gamma_correct(s_framebuf[i].warm)    * master / 255;
-        uint8_t n = (uint16_t)gamma_correct(s_framebuf[i].neutral) * master / 255;
-        uint8_t c = (uint16_t)gamma_correct(s_framebuf[i].cool)    * master / 255;
-
-        /* SK6812WWA byte order: [cool, warm, neutral] */
-        s_tx_buf[i * 3 + 0] = c;
-        s_tx_buf[i * 3 + 1] = w;
-        s_tx_buf[i * 3 + 2] = n;
-    }
-    /* Transmit under lock — s_tx_buf must not be modified while the RMT
-     * encoder is progressively reading it during ping-pong refill. */
-    rmt_transmit_config_t tx_config = {
-        .loop_count = 0,
-    };
-    rmt_transmit(s_rmt_chan, s_encoder, s_tx_buf, sizeof(s_tx_buf), &tx_config);
-    rmt_tx_wait_all_done(s_rmt_chan, portMAX_DELAY);
+    s_flush_req = true;
+    xSemaphoreGive(s_mutex);
+    led_render_kick();
+}
+
+void lamp_write_frame(const led_pixel_t *frame, uint8_t master)
+{
+    if (!frame) return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(s_framebuf, frame, sizeof(s_framebuf));
+    s_master = level_from_u8(master);
+    s_flush_req = true;
+    xSemaphoreGive(s_mutex);
+    led_render_kick();
+}
+
+void led_driver_get_stats(led_driver_stats_t *out)
+{
+    if (!out) return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_mutex);
+}
+
+void led_driver_note_tick(int64_t interval_us, int64_t period_us, bool missed)
+{
+    int64_t dev = interval_us - period_us;
+    if (dev < 0) dev = -dev;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    hist_add(&s_timing.jitter, (uint32_t)dev);
+    if (missed) s_timing.missed_ticks++;
+    xSemaphoreGive(s_mutex);
+}
+
+void led_driver_note_rate_change(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_timing.rate_changes++;
     xSemaphoreGive(s_mutex);
 }
 
+void led_driver_get_timing(led_timing_t *out)
+{
+    if (!out) return;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&s_tx_lock);
+    *out = s_timing;
+    taskEXIT_CRITICAL(&s_tx_lock);
+    xSemaphoreGive(s_mutex);
+}
+
+void led_driver_reset_timing(void)
+{
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&s_tx_lock);
+    memset(&s_timing, 0, sizeof(s_timing));
+    taskEXIT_CRITICAL(&s_tx_lock);
+    xSemaphoreGive(s_mutex);
+}
+
+static void log_hist(const char *name, const led_hist_t *h)
+{
+    char line[LED_HIST_BINS * 11 + 1];
+    int n = 0;
+    for (int i = 0; i < LED_HIST_BINS; i++) {
+        n += snprintf(line + n, sizeof(line) - n, " %lu", (unsigned long)h->bins[i]);
+    }
+    ESP_LOGI(TAG, "  %-9s max=%6luus |%s", name, (unsigned long)h->max_us, line);
+}
+
+void led_driver_log_timing(void)
+{
+    led_driver_stats_t st;
+    led_timing_t tm;
+    led_driver_get_stats(&st);
+    led_driver_get_timing(&tm);
+
+    ESP_LOGI(TAG, "Frames=%lu dropped=%lu skipped=%lu tx_errors=%lu missed_ticks=%lu "
+             "rate_changes=%lu fps=%u",
+             (unsigned long)st.frames, (unsigned long)st.dropped,
+             (unsigned long)st.skipped, (unsigned long)st.tx_errors,
+             (unsigned long)tm.missed_ticks, (unsigned long)tm.rate_changes,
+             lamp_render_get_fps());
+    ESP_LOGI(TAG, "Timing histograms (bin i counts samples < 16<<i us):");
+    log_hist("pack",      &tm.pack);
+    log_hist("lock_wait", &tm.lock_wait);
+    log_hist("tx",        &tm.tx);
+    log_hist("jitter",    &tm.jitter);
+}
+
 void lamp_off(void)
 {
     lamp_fill(0, 0, 0);
@@ -1,5 +1,12 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
 #include "led_encoder.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
+#if CONFIG_LED_DRIVER_RMT_ENCODE_STATS
+#include "esp_cpu.h"
+#endif
 
 static const char *TAG = "sk6812_enc";
 
@@ -12,6 +19,101 @@ static const char *TAG = "sk6812_enc";
  * RMT resolution is set to 10 MHz (100 ns per tick).
  */
 
+#define SK6812_BIT0     ((rmt_symbol_word_t){ .duration0 = 3, .level0 = 1, .duration1 = 9, .level1 = 0 })
+#define SK6812_BIT1     ((rmt_symbol_word_t){ .duration0 = 6, .level0 = 1, .duration1 = 6, .level1 = 0 })
+/* Reset pulse: 800 ticks × 100 ns = 80 us low */
+#define SK6812_RESET    ((rmt_symbol_word_t){ .duration0 = 800, .level0 = 0, .duration1 = 0, .level1 = 0 })
+
+/* ── Encode-call timing (runs in the RMT ISR while streaming) ── */
+
+#if CONFIG_LED_DRIVER_RMT_ENCODE_STATS
+static sk6812_encoder_stats_t s_stats;
+
+#define ENC_STATS_BEGIN()   esp_cpu_cycle_count_t _t0 = esp_cpu_get_cycle_count()
+#define ENC_STATS_END()     do {                                            \
+        uint32_t _dt = esp_cpu_get_cycle_count() - _t0;                     \
+        s_stats.calls++;                                                    \
+        s_stats.total_cycles += _dt;                                        \
+        if (_dt > s_stats.max_cycles) s_stats.max_cycles = _dt;             \
+    } while (0)
+
+void sk6812_encoder_get_stats(sk6812_encoder_stats_t *out, bool reset)
+{
+    *out = s_stats;
+    if (reset) memset(&s_stats, 0, sizeof(s_stats));
+}
+#else
+#define ENC_STATS_BEGIN()   do { } while (0)
+#define ENC_STATS_END()     do { } while (0)
+#endif
+
+#if CONFIG_LED_DRIVER_RMT_ENCODER_TABLE
+
+/*
+ * Table encoder: a 256 × 8-symbol lookup built once at creation.  The
+ * rmt_simple_encoder callback copies eight pre-built symbols per byte
+ * straight into channel memory — no per-bit branching in the refill ISR.
+ * The table lives in internal RAM (8 KB) so the ISR never touches flash.
+ */
+
+typedef struct {
+    rmt_symbol_word_t (*table)[8];      /* [byte value][bit, MSB first] */
+} sk6812_table_ctx_t;
+
+static sk6812_table_ctx_t s_table_ctx;
+
+static size_t IRAM_ATTR sk6812_table_encode(const void *data, size_t data_size,
+                                            size_t symbols_written, size_t symbols_free,
+                                            rmt_symbol_word_t *symbols, bool *done, void *arg)
+{
+    ENC_STATS_BEGIN();
+    const sk6812_table_ctx_t *ctx = arg;
+    const uint8_t *bytes = data;
+    size_t pos = symbols_written / 8;
+    size_t out = 0;
+
+    if (pos < data_size) {
+        /* min_chunk_size = 8 guarantees room for at least one byte */
+        size_t n = symbols_free / 8;
+        if (n > data_size - pos) n = data_size - pos;
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&symbols[i * 8], ctx->table[bytes[pos + i]], 8 * sizeof(rmt_symbol_word_t));
+        }
+        out = n * 8;
+    } else {
+        symbols[0] = SK6812_RESET;
+        *done = true;
+        out = 1;
+    }
+    ENC_STATS_END();
+    return out;
+}
+
+esp_err_t sk6812_encoder_new(rmt_encoder_handle_t *ret_encoder)
+{
+    ESP_RETURN_ON_FALSE(ret_encoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    if (!s_table_ctx.table) {
+        s_table_ctx.table = heap_caps_malloc(256 * sizeof(*s_table_ctx.table),
+                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        ESP_RETURN_ON_FALSE(s_table_ctx.table, ESP_ERR_NO_MEM, TAG, "no memory for symbol table");
+        for (int v = 0; v < 256; v++) {
+            for (int b = 0; b < 8; b++) {
+                s_table_ctx.table[v][b] = (v & (0x80 >> b)) ? SK6812_BIT1 : SK6812_BIT0;
+            }
+        }
+    }
+
+    rmt_simple_encoder_config_t cfg = {
+        .callback       = sk6812_table_encode,
+        .arg            = &s_table_ctx,
+        .min_chunk_size = 8,
+    };
+    return rmt_new_simple_encoder(&cfg, ret_encoder);
+}
+
+#else /* CONFIG_LED_DRIVER_RMT_ENCODER_BYTES */
+
 typedef struct {
     rmt_encoder_t           base;
     rmt_encoder_handle_t    bytes_encoder;
@@ -24,6 +126,7 @@ static size_t sk6812_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel
                             const void *primary_data, size_t data_size,
                             rmt_encode_state_t *ret_state)
 {
+    ENC_STATS_BEGIN();
     sk6812_encoder_t *enc = __containerof(encoder, sk6812_encoder_t, base);
     rmt_encode_state_t session_state = RMT_ENCODING_RESET;
     size_t encoded_symbols = 0;
@@ -39,6 +142,7 @@ static size_t sk6812_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel
         }
         if (session_state & RMT_ENCODING_MEM_FULL) {
             *ret_state = (rmt_encode_state_t)RMT_ENCODING_MEM_FULL;
+            ENC_STATS_END();
             return encoded_symbols;
         }
     }
@@ -56,11 +160,13 @@ static size_t sk6812_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel
         if (session_state & RMT_ENCODING_MEM_FULL) {
             *ret_state = (rmt_encode_state_t)RMT_ENCODING_MEM_FULL;
         }
+        ENC_STATS_END();
         return encoded_symbols;
     }
     }
 
     *ret_state = (rmt_encode_state_t)RMT_ENCODING_COMPLETE;
+    ENC_STATS_END();
     return encoded_symbols;
 }
 
@@ -97,18 +203,8 @@ esp_err_t sk6812_encoder_new(rmt_encoder_handle_t *ret_encoder)
     /* Bytes encoder: converts each byte into 8 NZR bit waveforms.
      * Resolution = 10 MHz → 1 tick = 100 ns. */
     rmt_bytes_encoder_config_t bytes_cfg = {
-        .bit0 = {
-            .duration0 = 3,     /* T0H = 300 ns */
-            .level0    = 1,
-            .duration1 = 9,     /* T0L = 900 ns */
-            .level1    = 0,
-        },
-        .bit1 = {
-            .duration0 = 6,     /* T1H = 600 ns */
-            .level0    = 1,
-            .duration1 = 6,     /* T1L = 600 ns */
-            .level1    = 0,
-        },
+        .bit0 = SK6812_BIT0,    /* T0H = 300 ns, T0L = 900 ns */
+        .bit1 = SK6812_BIT1,    /* T1H = 600 ns, T1L = 600 ns */
         .flags.msb_first = 1,
     };
     esp_err_t ret = rmt_new_bytes_encoder(&bytes_cfg, &enc->bytes_encoder);
@@ -119,13 +215,7 @@ esp_err_t sk6812_encoder_new(rmt_encoder_handle_t *ret_encoder)
     ret = rmt_new_copy_encoder(&copy_cfg, &enc->copy_encoder);
     ESP_GOTO_ON_ERROR(ret, err, TAG, "create copy encoder failed");
 
-    /* Reset pulse: 800 ticks × 100 ns = 80 us low */
-    enc->reset_code = (rmt_symbol_word_t){
-        .duration0 = 800,
-        .level0    = 0,
-        .duration1 = 0,
-        .level1    = 0,
-    };
+    enc->reset_code = SK6812_RESET;
 
     *ret_encoder = &enc->base;
     return ESP_OK;
@@ -136,3 +226,5 @@ err:
     free(enc);
     return ret;
 }
+
+#endif /* CONFIG_LED_DRIVER_RMT_ENCODER_TABLE */
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "sdkconfig.h"
 #include "driver/rmt_encoder.h"
 
 #ifdef __cplusplus
@@ -10,14 +12,31 @@ extern "C" {
 /**
  * Create an RMT encoder for SK6812WWA NZR protocol.
  *
- * Each LED consumes 4 bytes: [warm, neutral, cool, 0x00].
+ * Each LED consumes 3 bytes: [cool, warm, neutral].
  * The encoder emits NZR bit-level waveforms followed by a >=80 us reset pulse.
+ * CONFIG_LED_DRIVER_RMT_ENCODER selects the precomputed symbol table
+ * (default) or the generic bytes + copy encoder chain.
  *
  * @param[out] ret_encoder  Pointer to receive the created encoder handle.
  * @return ESP_OK on success.
  */
 esp_err_t sk6812_encoder_new(rmt_encoder_handle_t *ret_encoder);
 
+#if CONFIG_LED_DRIVER_RMT_ENCODE_STATS
+/* Encoder invocations — each one runs in the RMT ISR (or rmt_transmit for
+ * the first fill) */
+typedef struct {
+    uint32_t calls;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} sk6812_encoder_stats_t;
+
+/**
+ * Read (and optionally clear) the encode-call timing.
+ */
+void sk6812_encoder_get_stats(sk6812_encoder_stats_t *out, bool reset);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,302 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "lamp_fade.h"
+#include "lamp_render.h"
+#include "led_gamma.h"
+#include "led_internal.h"
+
+static const char *TAG = "led_fade";
+
+/* Channels while fading, all Q16 with 1.0 = 65536: colour as byte / 255,
+ * master and envelope on the perceptual scale */
+enum { CH_WARM, CH_NEUTRAL, CH_COOL, CH_MASTER, CH_ENVELOPE, CH_COUNT };
+
+static const uint8_t s_ch_mask[CH_COUNT] = {
+    LAMP_FADE_COLOR, LAMP_FADE_COLOR, LAMP_FADE_COLOR, LAMP_FADE_MASTER, LAMP_FADE_ENVELOPE,
+};
+
+/* Perceptual → light: round((i / 256)^2.2 × 65536), interpolated between
+ * entries; entry 256 is GAMMA_LEVEL_FULL */
+static const uint16_t s_pow22[256] = {
+        0,     0,     2,     4,     7,    11,    17,    24,    32,    41,    52,    64,
+       78,    93,   110,   128,   147,   168,   191,   215,   240,   267,   296,   327,
+      359,   392,   428,   465,   504,   544,   586,   630,   676,   723,   772,   823,
+      875,   930,   986,  1044,  1104,  1165,  1229,  1294,  1361,  1430,  1501,  1574,
+     1648,  1725,  1803,  1884,  1966,  2050,  2136,  2224,  2314,  2406,  2500,  2596,
+     2693,  2793,  2895,  2998,  3104,  3212,  3322,  3433,  3547,  3663,  3781,  3901,
+     4022,  4146,  4272,  4400,  4530,  4663,  4797,  4933,  5072,  5212,  5355,  5500,
+     5646,  5795,  5946,  6100,  6255,  6412,  6572,  6734,  6897,  7063,  7232,  7402,
+     7574,  7749,  7926,  8105,  8286,  8470,  8655,  8843,  9033,  9225,  9419,  9616,
+     9815, 10016, 10219, 10425, 10632, 10842, 11055, 11269, 11486, 11705, 11926, 12149,
+    12375, 12603, 12833, 13066, 13301, 13538, 13777, 14019, 14263, 14509, 14758, 15009,
+    15262, 15518, 15775, 16036, 16298, 16563, 16830, 17100, 17371, 17646, 17922, 18201,
+    18482, 18766, 19051, 19340, 19630, 19923, 20219, 20516, 20817, 21119, 21424, 21731,
+    22041, 22353, 22667, 22984, 23303, 23625, 23949, 24275, 24604, 24935, 25269, 25605,
+    25944, 26285, 26628, 26974, 27322, 27673, 28026, 28382, 28740, 29100, 29463, 29828,
+    30196, 30566, 30939, 31314, 31692, 32072, 32455, 32840, 33228, 33618, 34010, 34405,
+    34803, 35203, 35605, 36010, 36418, 36828, 37240, 37656, 38073, 38493, 38916, 39341,
+    39768, 40199, 40631, 41066, 41504, 41944, 42387, 42832, 43280, 43731, 44184, 44639,
+    45097, 45558, 46021, 46487, 46955, 47426, 47899, 48375, 48854, 49335, 49818, 50305,
+    50794, 51285, 51779, 52276, 52775, 53276, 53781, 54288, 54797, 55309, 55824, 56341,
+    56861, 57384, 57909, 58437, 58967, 59500, 60036, 60574, 61115, 61658, 62204, 62753,
+    63304, 63858, 64415, 64974,
+};
+
+/* Disjoint channel sets (LAMP_FADE_*), so at most one fade per set */
+#define FADE_SLOTS  3
+
+typedef struct {
+    uint8_t             channels;       /* LAMP_FADE_* still owned; 0 = free */
+    lamp_ease_t         ease;
+    int32_t             from[CH_COUNT];
+    int32_t             to[CH_COUNT];
+    lamp_fade_level_t   target;         /* written exactly on the last frame */
+    int64_t             start_us;       /* 0 = take the first tick as start */
+    int64_t             duration_us;
+    lamp_fade_done_fn_t done;
+    void               *arg;
+} fade_t;
+
+/* Recursive: a done callback may start the next fade */
+static StaticSemaphore_t s_lock_buf;
+static SemaphoreHandle_t s_lock;
+static fade_t            s_fade[FADE_SLOTS];
+
+/* ── Fixed-point curves ── */
+
+static uint32_t to_light(uint32_t p)
+{
+    uint32_t i = p >> 8;
+    if (i >= 256) return GAMMA_LEVEL_FULL;
+    uint32_t a = s_pow22[i];
+    uint32_t b = i < 255 ? s_pow22[i + 1] : GAMMA_LEVEL_FULL;
+    return a + (((b - a) * (p & 0xFF)) >> 8);
+}
+
+/* Inverse of to_light (level^(1/2.2)) — once per channel per fade */
+static uint32_t to_perceptual(uint32_t level)
+{
+    if (level == 0) return 0;
+    if (level >= GAMMA_LEVEL_FULL) return GAMMA_LEVEL_FULL;
+    int lo = 0, hi = 255;
+    while (lo < hi) {                   /* last entry <= level */
+        int mid = (lo + hi + 1) / 2;
+        if (s_pow22[mid] <= level) lo = mid;
+        else hi = mid - 1;
+    }
+    uint32_t a = s_pow22[lo];
+    uint32_t b = lo < 255 ? s_pow22[lo + 1] : GAMMA_LEVEL_FULL;
+    uint32_t frac = b > a ? ((level - a) << 8) / (b - a) : 0;
+    return ((uint32_t)lo << 8) + (frac < 256 ? frac : 255);
+}
+
+/* Eased progress, Q16 in and out */
+static uint32_t ease(lamp_ease_t curve, uint32_t t)
+{
+    uint32_t u = GAMMA_LEVEL_FULL - t;
+    switch (curve) {
+    case LAMP_EASE_IN:
+        return (uint32_t)(((uint64_t)t * t) >> 16);
+    case LAMP_EASE_OUT:
+        return GAMMA_LEVEL_FULL - (uint32_t)(((uint64_t)u * u) >> 16);
+    case LAMP_EASE_IN_OUT:
+        /* 3t² − 2t³ */
+        return (uint32_t)(((uint64_t)t * t * (3 * GAMMA_LEVEL_FULL - 2 * t)) >> 32);
+    default:
+        return t;
+    }
+}
+
+static inline uint32_t u8_to_q16(uint8_t v)
+{
+    return ((uint32_t)v * GAMMA_LEVEL_FULL + 127) / 255;
+}
+
+static inline uint8_t q16_to_u8(int32_t v)
+{
+    return (uint8_t)(((uint32_t)v * 255 + GAMMA_LEVEL_FULL / 2) >> 16);
+}
+
+/* ── Output ── */
+
+/* Write channel values (perceptual Q16) for the selected channels */
+static void fade_write(uint8_t channels, const int32_t v[CH_COUNT])
+{
+    if (channels & LAMP_FADE_COLOR) {
+        lamp_fill(q16_to_u8(v[CH_WARM]), q16_to_u8(v[CH_NEUTRAL]), q16_to_u8(v[CH_COOL]));
+    }
+    if (channels & (LAMP_FADE_MASTER | LAMP_FADE_ENVELOPE)) {
+        led_driver_set_levels(channels, to_light(v[CH_MASTER]), to_light(v[CH_ENVELOPE]));
+    }
+}
+
+/* Exact target values, so a fade always lands on the byte setters' levels */
+static void fade_write_target(uint8_t channels, const lamp_fade_level_t *to)
+{
+    if (channels & LAMP_FADE_COLOR)    lamp_fill(to->warm, to->neutral, to->cool);
+    if (channels & LAMP_FADE_MASTER)   lamp_set_master(to->master);
+    if (channels & LAMP_FADE_ENVELOPE) lamp_set_fade(to->envelope);
+}
+
+/* ── Animator ── */
+
+static bool fade_running(void)
+{
+    for (int i = 0; i < FADE_SLOTS; i++) {
+        if (s_fade[i].channels) return true;
+    }
+    return false;
+}
+
+static bool fade_animate(int64_t now_us, void *arg)
+{
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+
+    int32_t v[CH_COUNT] = {0};
+    uint8_t stepping = 0;
+    struct { lamp_fade_done_fn_t fn; void *arg; } done[FADE_SLOTS];
+    int n_done = 0;
+
+    for (int i = 0; i < FADE_SLOTS; i++) {
+        fade_t *f = &s_fade[i];
+        if (!f->channels) continue;
+
+        if (f->start_us == 0) f->start_us = now_us;
+        int64_t elapsed = now_us - f->start_us;
+        if (elapsed >= f->duration_us) {
+            fade_write_target(f->channels, &f->target);
+            f->channels = 0;
+            if (f->done) {
+                done[n_done].fn  = f->done;
+                done[n_done].arg = f->arg;
+                n_done++;
+            }
+            continue;
+        }
+        uint32_t e = ease(f->ease, (uint32_t)((elapsed << 16) / f->duration_us));
+        for (int c = 0; c < CH_COUNT; c++) {
+            if (!(f->channels & s_ch_mask[c])) continue;
+            v[c] = f->from[c] + (int32_t)(((int64_t)(f->to[c] - f->from[c]) * e) >> 16);
+        }
+        stepping |= f->channels;
+    }
+    if (stepping) fade_write(stepping, v);
+    lamp_flush();
+
+    for (int i = 0; i < n_done; i++) done[i].fn(done[i].arg);
+    /* Keep ticking while fades remain, including any a callback chained */
+    bool keep = fade_running();
+    xSemaphoreGiveRecursive(s_lock);
+    return keep;
+}
+
+/* ── Public API ── */
+
+esp_err_t led_fade_init(void)
+{
+    s_lock = xSemaphoreCreateRecursiveMutexStatic(&s_lock_buf);
+    ESP_RETURN_ON_FALSE(s_lock, ESP_FAIL, TAG, "fade lock create failed");
+    return ESP_OK;
+}
+
+/* Take @p channels away from running fades; a fade left with none is
+ * dropped without its done callback.  Call under s_lock. */
+static void fade_release(uint8_t channels)
+{
+    for (int i = 0; i < FADE_SLOTS; i++) s_fade[i].channels &= ~channels;
+}
+
+static bool same_target(uint8_t channels, const lamp_fade_level_t *a, const lamp_fade_level_t *b)
+{
+    if ((channels & LAMP_FADE_COLOR) &&
+        (a->warm != b->warm || a->neutral != b->neutral || a->cool != b->cool)) return false;
+    if ((channels & LAMP_FADE_MASTER) && a->master != b->master) return false;
+    if ((channels & LAMP_FADE_ENVELOPE) && a->envelope != b->envelope) return false;
+    return true;
+}
+
+esp_err_t lamp_fade_to(const lamp_fade_level_t *to, uint8_t channels, uint32_t duration_ms,
+                       lamp_ease_t curve, lamp_fade_done_fn_t done, void *arg)
+{
+    channels &= LAMP_FADE_COLOR | LAMP_FADE_MASTER | LAMP_FADE_ENVELOPE;
+    if (!to || !channels) return ESP_ERR_INVALID_ARG;
+
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    for (int i = 0; i < FADE_SLOTS; i++) {
+        const fade_t *f = &s_fade[i];
+        if (duration_ms > 0 && f->channels == channels && f->done == done &&
+            f->arg == arg && same_target(channels, &f->target, to)) {
+            /* Already on its way there (e.g. a repeated sync packet) —
+             * restarting would reset the easing every time */
+            xSemaphoreGiveRecursive(s_lock);
+            return ESP_OK;
+        }
+    }
+
+    fade_release(channels);
+    if (duration_ms == 0) {
+        fade_write_target(channels, to);
+        xSemaphoreGiveRecursive(s_lock);
+        lamp_flush();
+        if (done) done(arg);
+        return ESP_OK;
+    }
+
+    /* Channels are disjoint between fades, so a slot is always free */
+    fade_t *f = NULL;
+    for (int i = 0; i < FADE_SLOTS && !f; i++) {
+        if (!s_fade[i].channels) f = &s_fade[i];
+    }
+
+    /* Start from what the compositor shows — mid-fade included */
+    uint32_t master, fade;
+    led_pixel_t color;
+    led_driver_get_levels(&master, &fade, &color);
+    f->from[CH_WARM]     = u8_to_q16(color.warm);
+    f->from[CH_NEUTRAL]  = u8_to_q16(color.neutral);
+    f->from[CH_COOL]     = u8_to_q16(color.cool);
+    f->from[CH_MASTER]   = to_perceptual(master);
+    f->from[CH_ENVELOPE] = to_perceptual(fade);
+    f->to[CH_WARM]       = u8_to_q16(to->warm);
+    f->to[CH_NEUTRAL]    = u8_to_q16(to->neutral);
+    f->to[CH_COOL]       = u8_to_q16(to->cool);
+    f->to[CH_MASTER]     = to_perceptual(u8_to_q16(to->master));
+    f->to[CH_ENVELOPE]   = to_perceptual(u8_to_q16(to->envelope));
+    f->target      = *to;
+    f->ease        = curve;
+    f->start_us    = 0;
+    f->duration_us = (int64_t)duration_ms * 1000;
+    f->done        = done;
+    f->arg         = arg;
+    f->channels    = channels;
+
+    /* Fades are smoothest at the top rate; the render task still steps
+     * down under load */
+    esp_err_t ret = lamp_animator_start(fade_animate, NULL);
+    if (ret == ESP_OK) lamp_animator_set_fps(fade_animate, NULL, LAMP_RENDER_FPS_MAX);
+    else f->channels = 0;
+    xSemaphoreGiveRecursive(s_lock);
+    return ret;
+}
+
+void lamp_fade_stop(lamp_fade_done_fn_t done, void *arg)
+{
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+    for (int i = 0; i < FADE_SLOTS; i++) {
+        if (!done || (s_fade[i].done == done && s_fade[i].arg == arg)) {
+            s_fade[i].channels = 0;
+        }
+    }
+    xSemaphoreGiveRecursive(s_lock);
+}
+
+bool lamp_fade_is_running(uint8_t channels)
+{
+    for (int i = 0; i < FADE_SLOTS; i++) {
+        if (s_fade[i].channels & channels) return true;
+    }
+    return false;
+}
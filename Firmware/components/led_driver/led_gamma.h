@@ -6,3 +6,19 @@
  * Apply gamma 2.2 correction to an 8-bit value.
  */
 uint8_t gamma_correct(uint8_t val);
+
+/* Brightness level at full scale (Q16) */
+#define GAMMA_LEVEL_FULL    65536u
+
+/**
+ * Set the brightness (master × fade, Q16) folded into the combined gamma
+ * table.  The table is only marked stale when the value changes; it is
+ * rebuilt lazily on the next gamma_master_table() call.  Not thread-safe —
+ * the LED driver calls both under its framebuffer mutex.
+ */
+void gamma_set_level(uint32_t level);
+
+/**
+ * Combined lookup table: out = gamma(in) * level, rounded to 8 bits.
+ */
+const uint8_t *gamma_master_table(void);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "led_driver.h"
+
+/* Private interface between led_driver.c, led_render.c and led_fade.c */
+
+/* ── led_render.c ── */
+
+/* Create the render task (called from led_driver_init). */
+esp_err_t led_render_init(void);
+
+/* Wake the render task (flush requested / animator added); a no-op on the
+ * render task itself, which re-checks both before it sleeps. */
+void led_render_kick(void);
+
+/* Wake the render task from ISR context.  Returns true if a yield is needed. */
+bool led_render_kick_from_isr(void);
+
+/* ── led_driver.c ── */
+
+/* Flush the frame buffer if a flush was requested since the last one. */
+void led_driver_render_flush(void);
+
+/* Ticks until the last frame sent is due for its forced refresh
+ * (CONFIG_LED_DRIVER_REFRESH_S): 0 when due, portMAX_DELAY if never.  The
+ * idle render task sleeps no longer than this; the flush above then
+ * repaints the frame even without a request. */
+TickType_t led_driver_refresh_wait(void);
+
+/* Hand a frame left pending by the TX-done ISR to the backend. */
+void led_driver_service_tx(void);
+
+/* Power management builds: disable the backend (dropping its PM lock) once
+ * no frame is on the wire or pending; the next transmit re-enables it.
+ * Returns false while the line is still busy. */
+bool led_driver_release_backend(void);
+
+/* Record one render tick: interval since the previous tick, the period it
+ * was scheduled at, and whether the tick slipped a whole period. */
+void led_driver_note_tick(int64_t interval_us, int64_t period_us, bool missed);
+
+/* Record a change of the render tick rate. */
+void led_driver_note_rate_change(void);
+
+/* Fade engine access to the compositor: master and fade envelope as Q16
+ * levels (GAMMA_LEVEL_FULL = 1.0) and the colour of the first base pixel.
+ * The setter writes only the LAMP_FADE_MASTER / LAMP_FADE_ENVELOPE levels
+ * in @p channels, in one lock, so it never undoes a concurrent
+ * lamp_set_master() / lamp_set_fade() on a channel the fade does not own. */
+void led_driver_get_levels(uint32_t *master, uint32_t *fade, led_pixel_t *color);
+void led_driver_set_levels(uint8_t channels, uint32_t master, uint32_t fade);
+
+/* ── led_fade.c ── */
+
+/* Create the fade engine lock (called from led_driver_init). */
+esp_err_t led_fade_init(void);
@@ -0,0 +1,412 @@
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+#include "lamp_render.h"
+#include "led_internal.h"
+
+static const char *TAG = "led_render";
+
+#define RENDER_TASK_STACK       4096
+#define RENDER_TASK_PRIO        4
+#define RENDER_MAX_ANIMATORS    4
+
+/* Adaptive rate: load is judged over windows of RENDER_WINDOW_US.  Step
+ * down after RENDER_DOWN_MISSES missed ticks or when the average tick
+ * (animators + flush) takes over half the period; step up when a window
+ * had no misses and ticks took under an eighth of the period — a quarter
+ * at the doubled rate — and nothing has changed for RENDER_UP_HOLD_US. */
+#define RENDER_WINDOW_US        1000000
+#define RENDER_DOWN_MISSES      2
+#define RENDER_UP_HOLD_US       5000000
+
+typedef struct {
+    lamp_animator_fn_t fn;
+    void              *arg;
+    uint8_t            fps;     /* highest rate this animator can use */
+    uint32_t           gen;     /* moved on by every lamp_animator_start() */
+} animator_t;
+
+/* Render task only: tick schedule and rate controller.  Deadlines are
+ * base + n periods, computed in ticks so fractional periods (e.g. 16.7 ms)
+ * do not accumulate rounding. */
+typedef struct {
+    uint8_t    fps;             /* current rate = min(ceiling, load_fps) */
+    uint8_t    ceiling;         /* highest animator rate */
+    uint8_t    load_fps;        /* highest rate the load allows */
+    TickType_t base_tick;
+    uint32_t   n;               /* ticks since base_tick */
+    TickType_t next_tick;
+    TickType_t last_tick;       /* when the last tick ran */
+    int64_t    window_us;       /* start of the current load window */
+    uint32_t   frames;
+    uint32_t   missed;
+    int64_t    busy_us;
+    int64_t    settled_us;      /* last rate change or missed tick */
+} render_rate_t;
+
+/* Created once at init and never deleted — stack and TCB are static so
+ * the render task costs no heap */
+static StackType_t   s_stack[RENDER_TASK_STACK];
+static StaticTask_t  s_tcb;
+static TaskHandle_t  s_task;
+
+static portMUX_TYPE  s_lock = portMUX_INITIALIZER_UNLOCKED;
+static animator_t    s_anim[RENDER_MAX_ANIMATORS];
+static int           s_anim_count;
+static animator_t    s_current;     /* animator executing on the render task */
+static uint32_t      s_anim_gen;
+
+static render_rate_t    s_rate = { .load_fps = LAMP_RENDER_FPS_MAX };
+static volatile uint8_t s_fps;      /* published s_rate.fps, 0 while idle */
+
+#if CONFIG_PM_ENABLE
+/* Held while animating: full CPU clock and no light sleep between ticks */
+static esp_pm_lock_handle_t s_pm_lock;
+#endif
+
+/* Line idle poll when the last frame may still be on the wire (~1 ms) */
+#define RENDER_TX_POLL_MS       2
+
+/* lamp_animator_stop() callers blocked on an in-progress call of s_current */
+static StaticSemaphore_t s_stop_sem_buf;
+static SemaphoreHandle_t s_stop_sem;
+static int               s_stop_waiters;
+
+static bool animator_eq(animator_t a, lamp_animator_fn_t fn, void *arg)
+{
+    return a.fn == fn && a.arg == arg;
+}
+
+/* Supported rate at or below @p fps */
+static uint8_t rate_floor(uint8_t fps)
+{
+    if (fps >= LAMP_RENDER_FPS_MAX) return LAMP_RENDER_FPS_MAX;
+    if (fps >= LAMP_RENDER_FPS)     return LAMP_RENDER_FPS;
+    return LAMP_RENDER_FPS_MIN;
+}
+
+/* Highest rate any registered animator can use; call under s_lock */
+static uint8_t animator_ceiling(void)
+{
+    uint8_t fps = 0;
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        if (s_anim[i].fn && s_anim[i].fps > fps) fps = s_anim[i].fps;
+    }
+    return fps;
+}
+
+static inline int64_t rate_period_us(void)
+{
+    return 1000000 / s_rate.fps;
+}
+
+/* Schedule the tick after the one at @p tick at the current rate */
+static void rate_rebase(TickType_t tick)
+{
+    s_rate.base_tick = tick;
+    s_rate.n         = 1;
+    s_rate.next_tick = tick + (TickType_t)(configTICK_RATE_HZ / s_rate.fps);
+}
+
+static void rate_advance(TickType_t now)
+{
+    s_rate.last_tick = now;
+    if (++s_rate.n == s_rate.fps) {     /* whole second: keep n small */
+        s_rate.base_tick += configTICK_RATE_HZ;
+        s_rate.n = 0;
+    }
+    s_rate.next_tick = s_rate.base_tick +
+                       (TickType_t)((uint64_t)s_rate.n * configTICK_RATE_HZ / s_rate.fps);
+}
+
+static void rate_window_reset(int64_t now_us)
+{
+    s_rate.window_us = now_us;
+    s_rate.frames    = 0;
+    s_rate.missed    = 0;
+    s_rate.busy_us   = 0;
+}
+
+/* Apply min(ceiling, load_fps); the next tick is one new period after the
+ * last */
+static void rate_apply(int64_t now_us)
+{
+#if CONFIG_LED_DRIVER_RENDER_ADAPTIVE
+    uint8_t fps = s_rate.ceiling < s_rate.load_fps ? s_rate.ceiling : s_rate.load_fps;
+#else
+    uint8_t fps = LAMP_RENDER_FPS;
+#endif
+    if (fps == s_rate.fps) return;
+    if (s_rate.fps) {
+        ESP_LOGI(TAG, "Render rate %u -> %u fps", s_rate.fps, fps);
+        led_driver_note_rate_change();
+    }
+    s_rate.fps        = fps;
+    s_rate.settled_us = now_us;
+    s_fps             = fps;
+    rate_rebase(s_rate.last_tick);
+    rate_window_reset(now_us);
+}
+
+/* Account one tick and, at the end of a window, adjust the load rate */
+static void rate_account(int64_t now_us, int64_t busy_us, bool missed)
+{
+#if CONFIG_LED_DRIVER_RENDER_ADAPTIVE
+    s_rate.frames++;
+    s_rate.busy_us += busy_us;
+    if (missed) {
+        s_rate.missed++;
+        s_rate.settled_us = now_us;
+    }
+    if (now_us - s_rate.window_us < RENDER_WINDOW_US) return;
+
+    int64_t period = rate_period_us();
+    int64_t busy   = s_rate.busy_us / s_rate.frames;
+    if ((s_rate.missed >= RENDER_DOWN_MISSES || busy > period / 2) &&
+        s_rate.fps > LAMP_RENDER_FPS_MIN) {
+        ESP_LOGW(TAG, "Load: %lu missed, %lld us/tick at %u fps — stepping down",
+                 (unsigned long)s_rate.missed, busy, s_rate.fps);
+        s_rate.load_fps = s_rate.fps / 2;
+    } else if (s_rate.missed == 0 && busy < period / 8 && s_rate.fps < s_rate.ceiling &&
+               now_us - s_rate.settled_us >= RENDER_UP_HOLD_US) {
+        s_rate.load_fps = s_rate.fps * 2;
+    }
+    rate_window_reset(now_us);
+    rate_apply(now_us);
+#endif
+}
+
+static void run_animators(int64_t now_us)
+{
+    /* Slots are re-read one at a time so an animator started or stopped by
+     * another animator (e.g. auto fade-out stopping flame) takes effect
+     * within the same tick. */
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        taskENTER_CRITICAL(&s_lock);
+        animator_t a = s_anim[i];
+        s_current = a;
+        taskEXIT_CRITICAL(&s_lock);
+        if (!a.fn) continue;
+
+        bool keep = a.fn(now_us, a.arg);
+
+        taskENTER_CRITICAL(&s_lock);
+        s_current = (animator_t){0};
+        /* A start while it ran (e.g. a new fade just after the last one
+         * finished) keeps the slot */
+        if (!keep && animator_eq(s_anim[i], a.fn, a.arg) && s_anim[i].gen == a.gen) {
+            s_anim[i] = (animator_t){0};
+            s_anim_count--;
+        }
+        int waiters = s_stop_waiters;
+        s_stop_waiters = 0;
+        taskEXIT_CRITICAL(&s_lock);
+
+        while (waiters--) xSemaphoreGive(s_stop_sem);
+    }
+}
+
+static void render_task(void *arg)
+{
+    bool    was_animating = false;
+    int64_t last_tick_us  = 0;
+
+    for (;;) {
+        taskENTER_CRITICAL(&s_lock);
+        bool    animating = s_anim_count > 0;
+        uint8_t ceiling   = animator_ceiling();
+        taskEXIT_CRITICAL(&s_lock);
+
+        /* Idle: sleep until a flush request or animator start.
+         * Animating: sleep until the next tick, but still wake for a frame
+         * left pending by the TX-done ISR. */
+        TickType_t wait = portMAX_DELAY;
+        if (animating) {
+            TickType_t now = xTaskGetTickCount();
+            if (!was_animating) {
+#if CONFIG_PM_ENABLE
+                esp_pm_lock_acquire(s_pm_lock);
+#endif
+                /* First tick now; the load rate carries over from the
+                 * last animation */
+                s_rate.fps       = 0;
+                s_rate.ceiling   = ceiling;
+                s_rate.last_tick = now;
+                rate_apply(esp_timer_get_time());
+                s_rate.n         = 0;
+                s_rate.next_tick = now;
+                last_tick_us     = 0;   /* no interval for the first tick */
+            } else if (ceiling != s_rate.ceiling) {
+                /* An animator changed its rate */
+                s_rate.ceiling = ceiling;
+                rate_apply(esp_timer_get_time());
+            }
+            wait = ((int32_t)(s_rate.next_tick - now) > 0) ? s_rate.next_tick - now : 0;
+        } else {
+            if (was_animating) {
+                s_fps = 0;
+#if CONFIG_PM_ENABLE
+                esp_pm_lock_release(s_pm_lock);
+#endif
+            }
+            /* Static or dark: let the backend drop its PM lock once the
+             * last frame is out, then sleep until a request or the frame's
+             * forced refresh */
+            wait = led_driver_release_backend() ? led_driver_refresh_wait()
+                                                : pdMS_TO_TICKS(RENDER_TX_POLL_MS);
+        }
+        was_animating = animating;
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        led_driver_service_tx();
+
+        bool       tick   = false;
+        bool       missed = false;
+        TickType_t now    = xTaskGetTickCount();
+        int64_t    now_us = 0;
+        if (animating && (int32_t)(now - s_rate.next_tick) >= 0) {
+            tick = true;
+            rate_advance(now);
+            /* Fell a whole period behind — re-phase instead of bursting */
+            missed = (int32_t)(now - s_rate.next_tick) >= 0;
+            if (missed) rate_rebase(now);
+
+            now_us = esp_timer_get_time();
+            if (last_tick_us) led_driver_note_tick(now_us - last_tick_us, rate_period_us(), missed);
+            last_tick_us = now_us;
+            run_animators(now_us);
+        }
+
+        /* One flush per tick while animating; flush requests between ticks
+         * are coalesced into the next one.  Idle: flush on request or
+         * refresh. */
+        if (!animating || tick) {
+            led_driver_render_flush();
+        }
+        if (tick) {
+            rate_account(now_us, esp_timer_get_time() - now_us, missed);
+        }
+    }
+}
+
+esp_err_t led_render_init(void)
+{
+#if CONFIG_PM_ENABLE
+    ESP_RETURN_ON_ERROR(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "lamp_render", &s_pm_lock),
+                        TAG, "PM lock create failed");
+#endif
+    s_stop_sem = xSemaphoreCreateCountingStatic(RENDER_MAX_ANIMATORS, 0, &s_stop_sem_buf);
+    s_task = xTaskCreateStaticPinnedToCore(render_task, "lamp_render", RENDER_TASK_STACK,
+                                           NULL, RENDER_TASK_PRIO, s_stack, &s_tcb, 0);
+    ESP_RETURN_ON_FALSE(s_task, ESP_FAIL, TAG, "render task create failed");
+    return ESP_OK;
+}
+
+void led_render_kick(void)
+{
+    /* Animators and fade callbacks flush from the render task itself, which
+     * flushes after running them anyway; a self-notify would only cost an
+     * extra loop wake-up */
+    if (s_task && xTaskGetCurrentTaskHandle() != s_task) xTaskNotifyGive(s_task);
+}
+
+bool IRAM_ATTR led_render_kick_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    if (s_task) vTaskNotifyGiveFromISR(s_task, &woken);
+    return woken == pdTRUE;
+}
+
+esp_err_t lamp_animator_start(lamp_animator_fn_t fn, void *arg)
+{
+    if (!fn) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&s_lock);
+    uint32_t gen = ++s_anim_gen;
+    int free_slot = -1;
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        if (animator_eq(s_anim[i], fn, arg)) {
+            s_anim[i].gen = gen;    /* re-armed: not freed by a call in progress */
+            free_slot = -1;
+            ret = ESP_OK;
+            break;
+        }
+        if (!s_anim[i].fn && free_slot < 0) free_slot = i;
+    }
+    if (free_slot >= 0) {
+        s_anim[free_slot] = (animator_t){ fn, arg, LAMP_RENDER_FPS, gen };
+        s_anim_count++;
+        ret = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "No free animator slot");
+        return ret;
+    }
+    led_render_kick();
+    return ESP_OK;
+}
+
+void lamp_animator_stop(lamp_animator_fn_t fn, void *arg)
+{
+    bool wait = false;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        if (animator_eq(s_anim[i], fn, arg)) {
+            s_anim[i] = (animator_t){0};
+            s_anim_count--;
+        }
+    }
+    /* Let an in-progress call finish so it cannot write a stale frame after
+     * the caller has taken over the frame buffer.  The render task releases
+     * the waiter as soon as the call returns (bounded by one animator
+     * frame, not a tick). */
+    if (xTaskGetCurrentTaskHandle() != s_task && animator_eq(s_current, fn, arg)) {
+        s_stop_waiters++;
+        wait = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+
+    if (wait) xSemaphoreTake(s_stop_sem, portMAX_DELAY);
+}
+
+bool lamp_animator_is_running(lamp_animator_fn_t fn, void *arg)
+{
+    bool found = false;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        if (animator_eq(s_anim[i], fn, arg)) found = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return found;
+}
+
+esp_err_t lamp_animator_set_fps(lamp_animator_fn_t fn, void *arg, uint8_t fps)
+{
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    taskENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < RENDER_MAX_ANIMATORS; i++) {
+        if (animator_eq(s_anim[i], fn, arg)) {
+            s_anim[i].fps = rate_floor(fps);
+            ret = ESP_OK;
+        }
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    /* The render task picks up the new ceiling before its next wait */
+    return ret;
+}
+
+uint8_t lamp_render_get_fps(void)
+{
+    return s_fps;
+}
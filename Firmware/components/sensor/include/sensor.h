@@ -28,6 +28,9 @@ typedef enum {
     SENSOR_EVT_LUX_UPDATE,
     SENSOR_EVT_SYNC,            /* ESP-NOW state received from peer */
     SENSOR_EVT_AUTO_UNSUPPRESS, /* suppress timer expired — re-enable auto mode */
+    SENSOR_EVT_TIMER,           /* lamp_timer deadline reached — run due callbacks */
+    SENSOR_EVT_TOUCH_WAKE,      /* touch pin went high while polling was parked */
+    SENSOR_EVT_FADE_DONE,       /* a fade landed on the render task — run its completion */
 } sensor_event_type_t;
 
 /** Full scene + operational state carried in a SENSOR_EVT_SYNC event. */
@@ -46,6 +49,9 @@ typedef struct {
                                   flicker_depth, flicker_speed */
     uint8_t  pir_sensitivity;
     uint8_t  lamp_on;         /* 0 = off, 1 = on (operational state) */
+    uint8_t  flame_style;     /* FLAME_STYLE_* */
+    uint8_t  effect_id;       /* EFFECT_ID_* */
+    uint16_t transition_ms;   /* crossfade length chosen by the sender */
 } sensor_sync_data_t;
 
 typedef struct {
@@ -82,6 +88,12 @@ esp_err_t sensor_set_pir_sensitivity(uint8_t level);
  */
 uint8_t sensor_get_pir_sensitivity(void);
 
+/**
+ * Resume touch polling if the pin woke it (SENSOR_EVT_TOUCH_WAKE); cheap
+ * otherwise.  Call on every pass of the task that runs lamp_timer callbacks.
+ */
+void sensor_touch_wake(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,7 @@
 #include "sensor.h"
 #include "sensor_internal.h"
 #include "esp_adc/adc_oneshot.h"
-#include "esp_timer.h"
+#include "lamp_timer.h"
 #include "esp_log.h"
 #include "esp_check.h"
 
@@ -15,7 +15,7 @@ static const char *TAG = "sensor_light";
 
 static QueueHandle_t        s_queue;
 static adc_oneshot_unit_handle_t s_adc_handle;
-static esp_timer_handle_t   s_timer;
+static lamp_timer_t         s_timer;
 static volatile uint8_t     s_lux;
 
 /* Median filter buffer */
@@ -82,12 +82,8 @@ esp_err_t sensor_light_init(QueueHandle_t event_queue)
                         TAG, "ADC channel config failed");
 
     /* Periodic sampling timer */
-    esp_timer_create_args_t timer_args = {
-        .callback = adc_sample_cb,
-        .name     = "light_adc",
-    };
-    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_timer), TAG, "timer create failed");
-    ESP_RETURN_ON_ERROR(esp_timer_start_periodic(s_timer, SAMPLE_INTERVAL_US), TAG, "timer start failed");
+    lamp_timer_init(&s_timer, "light_adc", adc_sample_cb, NULL);
+    lamp_timer_start_periodic(&s_timer, SAMPLE_INTERVAL_US);
 
     ESP_LOGI(TAG, "Ambient light sensor initialised (IO%d, ADC1_CH%d)",
              LIGHT_ADC_GPIO, LIGHT_ADC_CHANNEL);
@@ -1,3 +1,4 @@
+#include "sdkconfig.h"
 #include "sensor.h"
 #include "sensor_internal.h"
 #include "driver/gpio.h"
@@ -15,6 +16,11 @@ static void IRAM_ATTR pir_isr_handler(void *arg)
     QueueHandle_t queue = (QueueHandle_t)arg;
     int level = gpio_get_level(PIR_SIGNAL_GPIO);
     s_motion_active = (level != 0);
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    /* Light sleep only wakes on a level: wait for the opposite one, which
+     * gives one interrupt per edge */
+    gpio_wakeup_enable(PIR_SIGNAL_GPIO, level ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+#endif
 
     sensor_event_t evt = {
         .type = level ? SENSOR_EVT_MOTION_START : SENSOR_EVT_MOTION_END,
@@ -54,6 +60,12 @@ esp_err_t sensor_pir_init(QueueHandle_t event_queue)
 
     /* Read initial state */
     s_motion_active = (gpio_get_level(PIR_SIGNAL_GPIO) != 0);
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    /* Level-triggered wake-up instead of both edges (see pir_isr_handler).
+     * If the pin changed since the read, the interrupt fires at once. */
+    gpio_wakeup_enable(PIR_SIGNAL_GPIO,
+                       s_motion_active ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+#endif
 
     ESP_LOGI(TAG, "PIR sensor initialised (IO%d input, IO%d DAC sens=%u/31)",
              PIR_SIGNAL_GPIO, PIR_SENS_GPIO, s_sensitivity);
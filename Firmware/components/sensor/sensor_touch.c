@@ -1,7 +1,9 @@
+#include "sdkconfig.h"
 #include "sensor.h"
 #include "sensor_internal.h"
 #include "driver/gpio.h"
 #include "esp_timer.h"
+#include "lamp_timer.h"
 #include "esp_log.h"
 
 static const char *TAG = "sensor_touch";
@@ -14,6 +16,11 @@ static const char *TAG = "sensor_touch";
  * at a fixed 20 ms interval and require DEBOUNCE_THRESH consecutive readings
  * in the same direction before registering a state change.  This makes the
  * driver immune to rapid oscillation.
+ *
+ * With light sleep (CONFIG_LAMP_PM_LIGHT_SLEEP) polling stops after
+ * IDLE_POLLS released samples and a high level on the pin — which also
+ * wakes the chip — restarts it through SENSOR_EVT_TOUCH_WAKE.  The first
+ * edge only resumes polling; the debounce above still decides the press.
  */
 
 #define POLL_INTERVAL_US    (20000)     /* 20 ms polling period */
@@ -21,10 +28,11 @@ static const char *TAG = "sensor_touch";
 #define LONG_PRESS_US       (3000000)   /* 3 s for long press */
 #define MIN_PRESS_US        (150000)    /* 150 ms minimum valid press */
 #define LOCKOUT_US          (500000)    /* 500 ms post-event lockout */
+#define IDLE_POLLS          (50)        /* 1 s released before polling stops */
 
 static QueueHandle_t      s_queue;
-static esp_timer_handle_t s_poll_timer;
-static esp_timer_handle_t s_long_timer;
+static lamp_timer_t       s_poll_timer;
+static lamp_timer_t       s_long_timer;
 
 /* Debounce state */
 static int      s_integrator;       /* counts up when HIGH, down when LOW */
@@ -35,6 +43,30 @@ static int64_t  s_press_start_us;
 static int64_t  s_last_event_us;
 static bool     s_long_fired;
 
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+static int           s_idle_polls;
+static volatile bool s_wake_req;    /* set by the ISR, taken by sensor_touch_wake() */
+
+static void IRAM_ATTR touch_isr_handler(void *arg)
+{
+    /* Level-triggered: mask until polling has run its course.  The flag,
+     * not the event, carries the wake-up, so a full queue loses nothing. */
+    gpio_intr_disable(TOUCH_OUT_GPIO);
+    s_wake_req = true;
+    sensor_event_t evt = { .type = SENSOR_EVT_TOUCH_WAKE };
+    xQueueSendFromISR(s_queue, &evt, NULL);
+}
+
+/* Stop polling and wait for the pin to go high */
+static void touch_park(void)
+{
+    lamp_timer_stop(&s_poll_timer);
+    s_idle_polls = 0;
+    gpio_wakeup_enable(TOUCH_OUT_GPIO, GPIO_INTR_HIGH_LEVEL);
+    gpio_intr_enable(TOUCH_OUT_GPIO);
+}
+#endif
+
 static void long_press_cb(void *arg)
 {
     /* Timer fired while still pressed → long press */
@@ -65,14 +97,13 @@ static void poll_cb(void *arg)
         s_debounced_state = true;
         s_press_start_us = esp_timer_get_time();
         s_long_fired = false;
-        esp_timer_stop(s_long_timer);
-        esp_timer_start_once(s_long_timer, LONG_PRESS_US);
+        lamp_timer_start_once(&s_long_timer, LONG_PRESS_US);
         ESP_LOGD(TAG, "Touch started");
 
     } else if (s_debounced_state && s_integrator == 0) {
         /* ── Released ── */
         s_debounced_state = false;
-        esp_timer_stop(s_long_timer);
+        lamp_timer_stop(&s_long_timer);
 
         int64_t now = esp_timer_get_time();
         int64_t held = now - s_press_start_us;
@@ -86,6 +117,23 @@ static void poll_cb(void *arg)
             ESP_LOGI(TAG, "Short press detected (held %lld ms)", held / 1000);
         }
     }
+
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    if (raw || s_debounced_state) {
+        s_idle_polls = 0;
+    } else if (++s_idle_polls >= IDLE_POLLS) {
+        touch_park();
+    }
+#endif
+}
+
+void sensor_touch_wake(void)
+{
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    if (!s_wake_req) return;
+    s_wake_req = false;
+    lamp_timer_start_periodic(&s_poll_timer, POLL_INTERVAL_US);
+#endif
 }
 
 esp_err_t sensor_touch_init(QueueHandle_t event_queue)
@@ -103,19 +151,16 @@ esp_err_t sensor_touch_init(QueueHandle_t event_queue)
     gpio_config(&cfg);
 
     /* Long-press timer */
-    esp_timer_create_args_t long_args = {
-        .callback = long_press_cb,
-        .name     = "touch_long",
-    };
-    esp_timer_create(&long_args, &s_long_timer);
+    lamp_timer_init(&s_long_timer, "touch_long", long_press_cb, NULL);
 
     /* Polling timer — runs every 20 ms */
-    esp_timer_create_args_t poll_args = {
-        .callback = poll_cb,
-        .name     = "touch_poll",
-    };
-    esp_timer_create(&poll_args, &s_poll_timer);
-    esp_timer_start_periodic(s_poll_timer, POLL_INTERVAL_US);
+    lamp_timer_init(&s_poll_timer, "touch_poll", poll_cb, NULL);
+    lamp_timer_start_periodic(&s_poll_timer, POLL_INTERVAL_US);
+
+#if CONFIG_LAMP_PM_LIGHT_SLEEP
+    /* Parked-state wake-up; stays masked while polling */
+    gpio_isr_handler_add(TOUCH_OUT_GPIO, touch_isr_handler, NULL);
+#endif
 
     ESP_LOGI(TAG, "Touch sensor initialised (IO%d, polled every %d ms, thresh=%d)",
              TOUCH_OUT_GPIO, POLL_INTERVAL_US / 1000, DEBOUNCE_THRESH);
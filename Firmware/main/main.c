@@ -6,6 +6,8 @@
 #include "lamp_nvs.h"
 #include "lamp_ota.h"
 #include "led_driver.h"
+#include "lamp_timer.h"
+#include "lamp_pm.h"
 #include "sensor.h"
 #include "esp_now_sync.h"
 #include "ble_service.h"
@@ -27,18 +29,25 @@ void app_main(void)
     ESP_ERROR_CHECK(led_driver_init());
     lamp_off();
 
-    /* 4. Initialise sensors — creates the shared event queue */
+    /* 4. Start the timer wheel (sensor, auto and circadian timers live on it) */
+    ESP_ERROR_CHECK(lamp_timer_service_init());
+
+    /* 5. Power management — frequency scaling and light sleep when idle,
+     *    configured before the radios start */
+    ESP_ERROR_CHECK(lamp_pm_init());
+
+    /* 6. Initialise sensors — creates the shared event queue */
     QueueHandle_t sensor_queue = xQueueCreate(16, sizeof(sensor_event_t));
     assert(sensor_queue);
     ESP_ERROR_CHECK(sensor_init(sensor_queue));
 
-    /* 5. Initialise BLE stack (before WiFi — BT controller must init first on ESP32) */
+    /* 7. Initialise BLE stack (before WiFi — BT controller must init first on ESP32) */
     ESP_ERROR_CHECK(ble_init());
 
-    /* 6. Initialise ESP-NOW sync (WiFi STA + ESP-NOW, after BLE for coexistence) */
+    /* 8. Initialise ESP-NOW sync (WiFi STA + ESP-NOW, after BLE for coexistence) */
     ESP_ERROR_CHECK(esp_now_sync_init(sensor_queue));
 
-    /* 7. Start the central lamp controller (creates its own task) */
+    /* 9. Start the central lamp controller (creates its own task) */
     ESP_ERROR_CHECK(lamp_control_init(sensor_queue));
 
     ESP_LOGI(TAG, "Initialisation complete");
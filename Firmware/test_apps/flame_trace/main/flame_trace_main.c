@@ -0,0 +1,261 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_log.h"
+
+#include "flame_kernel.h"
+#include "flame_fire.h"
+#include "lamp_nvs.h"
+#include "lamp_render.h"
+
+static const char *TAG = "flame_trace";
+
+#define TRACE_MAGIC         0x54474C46      /* "FLGT" */
+#define TRACE_VERSION       1
+#define TRACE_SEED          0x466C616D65ULL
+#define TRACE_SECONDS       10
+#define FRAME_US            (1000000 / FLAME_KERNEL_FPS)
+#define BENCH_FRAMES        100000
+#define RATE_SECONDS        3600
+#define RATE_TOLERANCE      0.15    /* vs the nominal rate */
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t led_count;
+    uint32_t frames;
+    uint32_t fps;
+    uint64_t seed;
+} trace_header_t;           /* 24 bytes, then frames × LED_COUNT bytes */
+
+/* Render rates the kernels are checked at (lamp_render.h) */
+static const int s_rates[] = { LAMP_RENDER_FPS_MIN, LAMP_RENDER_FPS, LAMP_RENDER_FPS_MAX };
+#define RATE_COUNT  (sizeof(s_rates) / sizeof(s_rates[0]))
+
+/* One style under test: reset + step over a shared state */
+typedef struct {
+    const char *name;
+    void (*reset)(uint64_t seed);
+    void (*step)(const flame_params_t *p, int32_t dt_us, uint8_t level[LED_COUNT]);
+    void (*pos)(float *x, float *y);    /* hot-spot, NULL if none */
+    int tolerance;          /* per-LED difference accepted against golden */
+} trace_case_t;
+
+static flame_state_t      s_state;
+static flame_fire_state_t s_fire;
+
+static void float_reset(uint64_t seed) { flame_kernel_float_reset(&s_state, seed); }
+static void q15_reset(uint64_t seed)   { flame_kernel_q15_reset(&s_state, seed); }
+static void fire_reset(uint64_t seed)  { flame_fire_reset(&s_fire, seed); }
+
+static void float_pos(float *x, float *y) { flame_kernel_float_pos(&s_state, x, y); }
+static void q15_pos(float *x, float *y)   { flame_kernel_q15_pos(&s_state, x, y); }
+
+static void float_step(const flame_params_t *p, int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    flame_kernel_float_step(&s_state, p, dt_us, level);
+}
+
+static void q15_step(const flame_params_t *p, int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    flame_kernel_q15_step(&s_state, p, dt_us, level);
+}
+
+static void particles_step(const flame_params_t *p, int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    flame_kernel_particles_step(&s_state, p, dt_us, level);
+}
+
+static void fire_step(const flame_params_t *p, int32_t dt_us, uint8_t level[LED_COUNT])
+{
+    led_pixel_t color[LED_COUNT];   /* a function of level — not traced */
+    flame_fire_step(&s_fire, p, dt_us, level, color);
+}
+
+/* The float kernel's walk is exact IEEE arithmetic, but expf/sinf differ
+ * between C libraries by an ulp or so — allow one output step. */
+static const trace_case_t s_cases[] = {
+    { "float",     float_reset, float_step,     float_pos, 1 },
+    { "q15",       q15_reset,   q15_step,       q15_pos,   0 },
+    { "particles", q15_reset,   particles_step, q15_pos,   0 },
+    { "fire",      fire_reset,  fire_step,      NULL,      0 },
+};
+#define CASE_COUNT  (sizeof(s_cases) / sizeof(s_cases[0]))
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void generate(const trace_case_t *c, const flame_params_t *p,
+                     uint8_t *frames, int count)
+{
+    c->reset(TRACE_SEED);
+    for (int f = 0; f < count; f++) {
+        c->step(p, f ? FRAME_US : 0, frames + f * LED_COUNT);
+    }
+}
+
+static bool write_golden(const char *path, const uint8_t *frames, int count)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+    trace_header_t h = {
+        .magic = TRACE_MAGIC, .version = TRACE_VERSION, .led_count = LED_COUNT,
+        .frames = count, .fps = FLAME_KERNEL_FPS, .seed = TRACE_SEED,
+    };
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              fwrite(frames, LED_COUNT, count, fp) == (size_t)count;
+    return fclose(fp) == 0 && ok;
+}
+
+/* Compare against the golden trace; logs the first mismatch */
+static bool check_golden(const char *path, const trace_case_t *c,
+                         const uint8_t *frames, int count)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        ESP_LOGE(TAG, "%s: no golden trace at %s (run with FLAME_TRACE_UPDATE=1)", c->name, path);
+        return false;
+    }
+    trace_header_t h;
+    uint8_t *golden = malloc((size_t)count * LED_COUNT);
+    bool ok = golden && fread(&h, sizeof(h), 1, fp) == 1 &&
+              h.magic == TRACE_MAGIC && h.version == TRACE_VERSION &&
+              h.led_count == LED_COUNT && h.frames == (uint32_t)count &&
+              h.fps == FLAME_KERNEL_FPS && h.seed == TRACE_SEED &&
+              fread(golden, LED_COUNT, count, fp) == (size_t)count;
+    fclose(fp);
+    if (!ok) {
+        ESP_LOGE(TAG, "%s: %s is not a matching trace (format, length or seed)", c->name, path);
+        free(golden);
+        return false;
+    }
+
+    int max_diff = 0;
+    for (int k = 0; k < count * LED_COUNT; k++) {
+        int d = abs((int)frames[k] - (int)golden[k]);
+        if (d > c->tolerance) {
+            ESP_LOGE(TAG, "%s: frame %d LED D%d is %d, golden %d", c->name,
+                     k / LED_COUNT, k % LED_COUNT + 1, frames[k], golden[k]);
+            free(golden);
+            return false;
+        }
+        if (d > max_diff) max_diff = d;
+    }
+    free(golden);
+    ESP_LOGI(TAG, "%s: %d frames match (max diff %d)", c->name, count, max_diff);
+    return true;
+}
+
+/* Motion statistics of a style stepped at @p fps: mean squared hot-spot
+ * displacement per second, and mean output level */
+typedef struct {
+    double msd;
+    double level;
+} rate_stats_t;
+
+static rate_stats_t rate_stats(const trace_case_t *c, const flame_params_t *p, int fps)
+{
+    rate_stats_t r = { 0 };
+    uint8_t level[LED_COUNT];
+    float x0 = 0, y0 = 0;
+    c->reset(TRACE_SEED);
+    for (int f = 0; f < RATE_SECONDS * fps; f++) {
+        c->step(p, f ? 1000000 / fps : 0, level);
+        for (int i = 0; i < LED_COUNT; i++) r.level += level[i];
+        if (c->pos && f % fps == 0) {
+            float x, y;
+            c->pos(&x, &y);
+            if (f) r.msd += (x - x0) * (x - x0) + (y - y0) * (y - y0);
+            x0 = x;
+            y0 = y;
+        }
+    }
+    r.msd   /= RATE_SECONDS - 1;
+    r.level /= (double)RATE_SECONDS * fps * LED_COUNT;
+    return r;
+}
+
+/* The flame must move at the same speed whatever rate the render task
+ * picks: compare walk speed and brightness at each rate against nominal */
+static bool check_rates(const trace_case_t *c, const flame_params_t *p)
+{
+    rate_stats_t nominal = rate_stats(c, p, FLAME_KERNEL_FPS);
+    bool ok = true;
+    for (size_t i = 0; i < RATE_COUNT; i++) {
+        rate_stats_t r = rate_stats(c, p, s_rates[i]);
+        double dm = c->pos ? r.msd / nominal.msd - 1.0 : 0.0;
+        double dl = r.level / nominal.level - 1.0;
+        bool pass = fabs(dm) <= RATE_TOLERANCE && fabs(dl) <= RATE_TOLERANCE;
+        ESP_LOGI(TAG, "%s @ %d fps: walk %.3f/s (%+.1f%%), level %.1f (%+.1f%%)%s", c->name,
+                 s_rates[i], r.msd, dm * 100, r.level, dl * 100, pass ? "" : " — out of tolerance");
+        ok &= pass;
+    }
+    return ok;
+}
+
+static void bench(const trace_case_t *c, const flame_params_t *p)
+{
+    uint8_t level[LED_COUNT];
+    unsigned sink = 0;
+    c->reset(1);
+    int64_t t0 = now_ns();
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        c->step(p, FRAME_US, level);
+        sink += level[f % LED_COUNT];
+    }
+    int64_t dt = now_ns() - t0;
+    ESP_LOGI(TAG, "%s: %lld ns/frame (checksum %u)", c->name,
+             (long long)(dt / BENCH_FRAMES), sink);
+}
+
+void app_main(void)
+{
+    const char *dir = getenv("FLAME_GOLDEN_DIR");
+    if (!dir) dir = "golden";
+    bool update = getenv("FLAME_TRACE_UPDATE") != NULL;
+    const int count = TRACE_SECONDS * FLAME_KERNEL_FPS;
+
+    /* Defaults as stored in a fresh scene */
+    const flame_config_t cfg = {
+        FLAME_DRIFT_X_DEFAULT, FLAME_DRIFT_Y_DEFAULT, FLAME_RESTORE_DEFAULT,
+        FLAME_RADIUS_DEFAULT,  FLAME_BIAS_Y_DEFAULT,  FLAME_FLICKER_DEPTH_DEFAULT,
+        FLAME_FLICKER_SPEED_DEFAULT, FLAME_STYLE_DEFAULT,
+    };
+    flame_params_t p;
+    flame_kernel_derive(&cfg, &p);
+
+    uint8_t *frames = malloc((size_t)count * LED_COUNT);
+    if (!frames) abort();
+
+    int failed = 0;
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        const trace_case_t *c = &s_cases[i];
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.bin", dir, c->name);
+
+        generate(c, &p, frames, count);
+        if (update) {
+            if (write_golden(path, frames, count)) {
+                ESP_LOGI(TAG, "%s: wrote %d frames to %s", c->name, count, path);
+            } else {
+                ESP_LOGE(TAG, "%s: cannot write %s", c->name, path);
+                failed++;
+            }
+        } else if (!check_golden(path, c, frames, count)) {
+            failed++;
+        }
+        if (!check_rates(c, &p)) failed++;
+        bench(c, &p);
+    }
+    free(frames);
+
+    ESP_LOGI(TAG, "%s", failed ? "FAILED" : "OK");
+    fflush(stdout);
+    exit(failed ? 1 : 0);
+}
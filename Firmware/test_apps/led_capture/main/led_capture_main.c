@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+#include "led_driver.h"
+#include "lamp_render.h"
+
+static const char *TAG = "led_capture";
+
+#define FRAME_MS        (1000 / LAMP_RENDER_FPS)
+#define BENCH_FRAMES    2000
+
+/* Scripted sequence exercising every compositor layer; each step is one
+ * frame in the trace. */
+static void run_sequence(void)
+{
+    /* Static warm scene at full, then at half master */
+    lamp_fill(255, 80, 0);
+    lamp_set_master(255);
+    lamp_flush();
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+    lamp_set_master(128);
+    lamp_flush();
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+
+    /* Vertical gradient through the effect layer */
+    uint8_t level[LED_COUNT];
+    for (int i = 0; i < LED_COUNT; i++) {
+        level[i] = (uint8_t)(255 - led_coords[i].row * 36);
+    }
+    lamp_set_master(255);
+    lamp_set_effect(level);
+    lamp_flush();
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+    lamp_set_effect(NULL);
+
+    /* One-second fade out on the fade layer */
+    for (int f = LAMP_RENDER_FPS; f >= 0; f--) {
+        lamp_set_fade((uint8_t)(255 * f / LAMP_RENDER_FPS));
+        lamp_flush();
+        vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+    }
+    lamp_set_fade(255);
+
+    /* Overlay blink over black */
+    lamp_fill(0, 0, 0);
+    for (int b = 0; b < 4; b++) {
+        lamp_set_overlay(0, 0, 255, (b & 1) ? 0 : 160);
+        lamp_flush();
+        vTaskDelay(pdMS_TO_TICKS(150));
+    }
+    lamp_set_overlay(0, 0, 0, 0);
+}
+
+/* Leave a static scene alone: with no flush and no animator the render
+ * task must still repaint it once its forced refresh is due. */
+static bool check_refresh(void)
+{
+#if CONFIG_LED_DRIVER_REFRESH_S > 0
+    led_driver_stats_t before, after;
+
+    lamp_fill(255, 80, 0);
+    lamp_flush();
+    vTaskDelay(pdMS_TO_TICKS(FRAME_MS));
+    led_driver_get_stats(&before);
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_LED_DRIVER_REFRESH_S * 1000 + 100));
+    led_driver_get_stats(&after);
+
+    uint32_t sent = (after.frames - after.skipped) - (before.frames - before.skipped);
+    if (sent == 0) {
+        ESP_LOGE(TAG, "Refresh: static scene not repainted after %d s", CONFIG_LED_DRIVER_REFRESH_S);
+        return false;
+    }
+    ESP_LOGI(TAG, "Refresh: static scene repainted %lu time(s) with no flush", (unsigned long)sent);
+#endif
+    return true;
+}
+
+/* Push frames that always differ through the real flush path as fast as
+ * the render task accepts them, then report the pack histogram. */
+static void run_bench(void)
+{
+    led_driver_reset_timing();
+    int64_t t0 = esp_timer_get_time();
+    for (int n = 0; n < BENCH_FRAMES; n++) {
+        lamp_fill((uint8_t)n, (uint8_t)(n >> 1), (uint8_t)(255 - n));
+        lamp_flush();
+        vTaskDelay(1);
+    }
+    int64_t dt = esp_timer_get_time() - t0;
+    ESP_LOGI(TAG, "Bench: %d flush requests in %lld us", BENCH_FRAMES, (long long)dt);
+    led_driver_log_timing();
+}
+
+void app_main(void)
+{
+    ESP_ERROR_CHECK(led_driver_init());
+
+    run_sequence();
+    if (!check_refresh()) {
+        fflush(stdout);
+        exit(1);
+    }
+    if (getenv("LED_BENCH")) {
+        run_bench();
+    } else {
+        led_driver_log_timing();
+    }
+
+    /* Let the render task drain the last request before exiting */
+    vTaskDelay(pdMS_TO_TICKS(100));
+    fflush(stdout);
+    exit(0);
+}
@@ -0,0 +1,346 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lamp_timer.h"
+
+static const char *TAG = "timer_wheel";
+
+#define TICK            LAMP_TIMER_TICK_US
+#define SLOTS           64                      /* per wheel level */
+#define HORIZON         (SLOTS * SLOTS * SLOTS - 1)   /* ticks */
+#define START_US        123456789LL             /* deliberately off a tick */
+#define RUN_LIMIT       10000000                /* runs per advance */
+#define SOAK_TIMERS     40
+#define SOAK_PERIODIC   5
+#define SOAK_HOURS      4
+
+/* ── Simulated clock ── */
+
+/* The wheel's hardware timer: armed deadline, fired by advance() */
+static int64_t s_now_us = START_US;
+static bool    s_hw_active;
+static int64_t s_hw_at_us;
+static int     s_hw_handle;
+static long    s_wakes;
+
+int64_t __wrap_esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+esp_err_t __wrap_esp_timer_create(const esp_timer_create_args_t *args,
+                                  esp_timer_handle_t *out)
+{
+    *out = (esp_timer_handle_t)&s_hw_handle;
+    return ESP_OK;
+}
+
+esp_err_t __wrap_esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    s_hw_active = true;
+    s_hw_at_us  = s_now_us + (int64_t)timeout_us;
+    return ESP_OK;
+}
+
+esp_err_t __wrap_esp_timer_stop(esp_timer_handle_t timer)
+{
+    s_hw_active = false;
+    return ESP_OK;
+}
+
+bool __wrap_esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return s_hw_active;
+}
+
+/* Move the clock to @p to_us, waking the wheel at every deadline it armed
+ * on the way, as the control task would */
+static bool advance(int64_t to_us)
+{
+    for (int runs = 0; s_hw_active && s_hw_at_us <= to_us; runs++) {
+        if (runs == RUN_LIMIT) {
+            ESP_LOGE(TAG, "wheel keeps re-arming at %lld us", (long long)s_hw_at_us);
+            return false;
+        }
+        if (s_hw_at_us > s_now_us) s_now_us = s_hw_at_us;
+        s_hw_active = false;
+        s_wakes++;
+        lamp_timer_run();
+    }
+    if (to_us > s_now_us) s_now_us = to_us;
+    return true;
+}
+
+/* ── Expectations ── */
+
+/* A timer under test: when it may fire, and what it did */
+typedef struct {
+    lamp_timer_t timer;
+    int64_t      due_us;        /* next allowed run, 0 = must not run */
+    int64_t      period_us;     /* periodic: due moves on by this */
+    int          runs;
+    int          errors;
+} probe_t;
+
+/* Runs must land in the tick after the deadline (start rounds up) */
+static void probe_cb(void *arg)
+{
+    probe_t *p = arg;
+    p->runs++;
+    int64_t late = s_now_us - p->due_us;
+    if (p->due_us == 0 || late < 0 || late >= TICK) {
+        ESP_LOGE(TAG, "%s: ran at %lld us, due %lld us", p->timer.name,
+                 (long long)s_now_us, (long long)p->due_us);
+        p->errors++;
+    }
+    if (p->period_us) {
+        p->due_us += p->period_us;
+    } else {
+        p->due_us = 0;
+    }
+}
+
+static void probe_init(probe_t *p, const char *name)
+{
+    lamp_timer_init(&p->timer, name, probe_cb, p);
+}
+
+static void probe_once(probe_t *p, int64_t delay_us)
+{
+    p->due_us    = s_now_us + delay_us;
+    p->period_us = 0;
+    lamp_timer_start_once(&p->timer, (uint64_t)delay_us);
+}
+
+static void probe_periodic(probe_t *p, int64_t period_us)
+{
+    p->due_us    = s_now_us + period_us;
+    p->period_us = period_us;
+    lamp_timer_start_periodic(&p->timer, (uint64_t)period_us);
+}
+
+/* Every probe ran @p runs times without an error */
+static bool probes_ok(const char *name, probe_t *p, int n, int runs)
+{
+    bool ok = true;
+    for (int i = 0; i < n; i++) {
+        if (p[i].errors || p[i].runs != runs) {
+            ESP_LOGE(TAG, "%s: %s ran %d times (want %d), %d early/late",
+                     name, p[i].timer.name, p[i].runs, runs, p[i].errors);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/* Clock to the start of the next tick whose level-0/1 slot indices are
+ * @p slot0 / @p slot1, with the wheel caught up */
+static bool seek_slots(int slot0, int slot1)
+{
+    int64_t tick = s_now_us / TICK + 1;
+    while ((tick % SLOTS) != slot0 || (tick / SLOTS % SLOTS) != slot1) tick++;
+    if (!advance(tick * TICK)) return false;
+    lamp_timer_run();
+    return true;
+}
+
+/* ── Cases ── */
+
+/* Deadlines either side of each level boundary: filed on the upper level,
+ * cascaded down and run on time */
+static bool test_cascade(void)
+{
+    static const int64_t ticks[] = {
+        1, SLOTS - 1, SLOTS, SLOTS + 1,
+        SLOTS * SLOTS - 1, SLOTS * SLOTS, SLOTS * SLOTS + 1, HORIZON,
+    };
+    enum { N = sizeof(ticks) / sizeof(ticks[0]) };
+    static probe_t p[N];
+
+    for (int i = 0; i < N; i++) {
+        probe_init(&p[i], "cascade");
+        probe_once(&p[i], ticks[i] * TICK - TICK / 3);
+    }
+    if (!advance(s_now_us + (HORIZON + 2) * (int64_t)TICK)) return false;
+    return probes_ok("cascade", p, N, 1);
+}
+
+/* Deadlines whose slot index wraps past the end of level 0, of level 1,
+ * and of both at once */
+static bool test_wrap(void)
+{
+    static probe_t p[4];
+    for (int i = 0; i < 4; i++) probe_init(&p[i], "wrap");
+
+    if (!seek_slots(SLOTS - 4, 7)) return false;
+    probe_once(&p[0], 10 * TICK);                       /* level 0 wraps */
+    if (!seek_slots(20, SLOTS - 2)) return false;
+    probe_once(&p[1], 3 * SLOTS * TICK);                /* level 1 wraps */
+    if (!seek_slots(SLOTS - 1, SLOTS - 1)) return false;
+    probe_once(&p[2], 2 * TICK);                        /* both wrap */
+    probe_once(&p[3], (SLOTS * SLOTS + 5) * (int64_t)TICK);   /* into level 2 */
+
+    if (!advance(s_now_us + (SLOTS * SLOTS + 10) * (int64_t)TICK)) return false;
+    return probes_ok("wrap", p, 4, 1);
+}
+
+/* Deadlines past the wheel's horizon are clamped to its last slot and
+ * re-filed as they come within range — neither early nor lost */
+static bool test_clamp(void)
+{
+    static probe_t p[3];
+    const int64_t hour = 3600LL * 1000000;
+    probe_init(&p[0], "clamp_1h");
+    probe_init(&p[1], "clamp_3h");
+    probe_init(&p[2], "clamp_24h");
+    probe_once(&p[0], hour + 7 * TICK / 2);
+    probe_once(&p[1], 3 * hour);
+    probe_once(&p[2], 24 * hour + 1);
+
+    long wakes = s_wakes;
+    if (!advance(s_now_us + 25 * hour)) return false;
+    ESP_LOGI(TAG, "clamp: 24 h in %ld wakes", s_wakes - wakes);
+    return probes_ok("clamp", p, 3, 1);
+}
+
+/* A stopped timer never runs — also once due but before lamp_timer_run() */
+static bool test_stop(void)
+{
+    static probe_t p[3];
+    probe_init(&p[0], "stop_early");
+    probe_init(&p[1], "stop_due");
+    probe_init(&p[2], "stop_far");
+    probe_once(&p[0], 50 * TICK);
+    probe_once(&p[1], 50 * TICK);
+    probe_once(&p[2], (SLOTS * SLOTS * 3) * (int64_t)TICK);
+
+    if (!advance(s_now_us + 10 * TICK)) return false;
+    lamp_timer_stop(&p[0].timer);
+    s_now_us += 60 * TICK;             /* due, wheel not yet woken */
+    lamp_timer_stop(&p[1].timer);
+    lamp_timer_stop(&p[2].timer);
+    for (int i = 0; i < 3; i++) p[i].due_us = 0;
+    if (!advance(s_now_us + (SLOTS * SLOTS * 4) * (int64_t)TICK)) return false;
+
+    bool ok = probes_ok("stop", p, 3, 0);
+    for (int i = 0; i < 3; i++) {
+        if (lamp_timer_is_active(&p[i].timer)) {
+            ESP_LOGE(TAG, "stop: %s still active", p[i].timer.name);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/* Periodic timers keep their phase, and a late loop skips the periods it
+ * missed instead of replaying them */
+static bool test_periodic(void)
+{
+    static probe_t p;
+    probe_init(&p, "periodic");
+    probe_periodic(&p, 20000);
+    if (!advance(s_now_us + 10 * 1000000)) return false;
+    bool ok = probes_ok("periodic", &p, 1, 500);
+
+    /* Block the loop for 5½ periods: one late run, then one period on
+     * from there, with the missed ones dropped */
+    int runs = p.runs;
+    s_now_us = (s_now_us / TICK + 11) * TICK;
+    p.due_us = s_now_us;
+    lamp_timer_run();
+    if (!advance(s_now_us + 1000000)) return false;
+    if (p.runs != runs + 1 + 50 || p.errors) {
+        ESP_LOGE(TAG, "periodic: %d runs in 1 s after a late loop (want 51), %d early/late",
+                 p.runs - runs, p.errors);
+        ok = false;
+    }
+    lamp_timer_stop(&p.timer);
+    return ok;
+}
+
+/* Random one-shots (some hours away, some restarted from their callback,
+ * some stopped) alongside periodic timers for SOAK_HOURS */
+static probe_t s_soak[SOAK_TIMERS];
+
+static void soak_cb(void *arg)
+{
+    probe_t *p = arg;
+    probe_cb(arg);
+    if (!p->period_us && rand() % 3 == 0) probe_once(p, rand() % 5000000);
+}
+
+static bool test_soak(void)
+{
+    srand(1);
+    for (int i = 0; i < SOAK_TIMERS; i++) {
+        lamp_timer_init(&s_soak[i].timer, "soak", soak_cb, &s_soak[i]);
+        if (i < SOAK_PERIODIC) {
+            probe_periodic(&s_soak[i], (i + 1) * 20000);
+        } else if (i % 4 == 0) {
+            probe_once(&s_soak[i], (int64_t)(rand() % 3) * 3600000000LL + rand() % 100000000);
+        } else {
+            probe_once(&s_soak[i], rand() % 50000000);
+        }
+    }
+
+    const int64_t end = s_now_us + SOAK_HOURS * 3600LL * 1000000;
+    while (s_now_us < end) {
+        if (!advance(s_now_us + 100000)) return false;
+        if (rand() % 500 == 0) {
+            probe_t *p = &s_soak[SOAK_PERIODIC + rand() % (SOAK_TIMERS - SOAK_PERIODIC)];
+            lamp_timer_stop(&p->timer);
+            p->due_us = 0;
+        }
+    }
+
+    bool ok = true;
+    for (int i = 0; i < SOAK_TIMERS; i++) {
+        if (s_soak[i].errors) ok = false;
+    }
+    for (int i = 0; i < SOAK_PERIODIC; i++) {
+        int want = (int)(SOAK_HOURS * 3600LL * 1000000 / s_soak[i].period_us);
+        if (s_soak[i].runs != want) {
+            ESP_LOGE(TAG, "soak: periodic %d ran %d times (want %d)", i, s_soak[i].runs, want);
+            ok = false;
+        }
+        lamp_timer_stop(&s_soak[i].timer);
+    }
+    for (int i = SOAK_PERIODIC; i < SOAK_TIMERS; i++) lamp_timer_stop(&s_soak[i].timer);
+    return ok;
+}
+
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} test_case_t;
+
+static const test_case_t s_cases[] = {
+    { "cascade",  test_cascade },
+    { "wrap",     test_wrap },
+    { "clamp",    test_clamp },
+    { "stop",     test_stop },
+    { "periodic", test_periodic },
+    { "soak",     test_soak },
+};
+#define CASE_COUNT  (sizeof(s_cases) / sizeof(s_cases[0]))
+
+void app_main(void)
+{
+    if (lamp_timer_service_init() != ESP_OK) abort();
+
+    int failed = 0;
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        long wakes = s_wakes;
+        bool ok = s_cases[i].run();
+        ESP_LOGI(TAG, "%s: %s (%ld wakes)", s_cases[i].name, ok ? "OK" : "FAILED",
+                 s_wakes - wakes);
+        if (!ok) failed++;
+    }
+
+    ESP_LOGI(TAG, "%s", failed ? "FAILED" : "OK");
+    fflush(stdout);
+    exit(failed ? 1 : 0);
+}
@@ -36,6 +36,7 @@ CHAR_PIR_SENS     = _char_uuid(0x0B)  # [level] 1B R/W
 CHAR_FLAME_CONFIG = _char_uuid(0x0C)  # 8B R/W
 CHAR_SYNC_CONFIG  = _char_uuid(0x0E)  # [group_id:u8, mac:6B] 7B R/W
 CHAR_LAMP_NAME    = _char_uuid(0x0F)  # UTF-8 string R/W
+CHAR_FRAME_DIAG   = _char_uuid(0x11)  # frame timing histograms R, [cmd] W
 
 # Known devices
 SN001_MAC = "C4:4F:33:11:AA:9F"
@@ -105,10 +106,12 @@ class LampBLE:
 
     # ── Mode Flags ──
 
-    async def set_flags(self, flags: int):
-        """Write mode flags (0x01=AUTO, 0x02=FLAME)."""
-        await self._client.write_gatt_char(CHAR_MODE_FLAGS, bytes([flags]))
-        print(f"[BLE] set_flags(0x{flags:02x})")
+    async def set_flags(self, flags: int, effect: Optional[int] = None):
+        """Write mode flags (0x01=AUTO, 0x02=EFFECT), optionally selecting the
+        effect (0=flame, 1=breathing, 2=sunrise, 3=wipe)."""
+        data = bytes([flags]) if effect is None else bytes([flags, effect])
+        await self._client.write_gatt_char(CHAR_MODE_FLAGS, data)
+        print(f"[BLE] set_flags(0x{flags:02x}, effect={effect})")
 
     async def get_flags(self) -> int:
         """Read mode flags."""
@@ -146,10 +149,10 @@ class LampBLE:
 
     async def set_flame_config(self, drift_x=128, drift_y=102, restore=20,
                                 radius=128, bias_y=128, flicker_depth=13,
-                                flicker_speed=13, brightness=255):
-        """Write flame config (8 bytes)."""
+                                flicker_speed=13, style=0):
+        """Write flame config (8 bytes). style: 0 = live, 1 = baked clip, 2 = particles, 3 = fire."""
         data = bytes([drift_x, drift_y, restore, radius, bias_y,
-                      flicker_depth, flicker_speed, brightness])
+                      flicker_depth, flicker_speed, style])
         await self._client.write_gatt_char(CHAR_FLAME_CONFIG, data)
         print(f"[BLE] set_flame_config(...)")
 
@@ -161,7 +164,8 @@ class LampBLE:
                           auto_timeout_s: int = 300, auto_lux: int = 185,
                           flame_drift_x=128, flame_drift_y=102, flame_restore=20,
                           flame_radius=128, flame_bias_y=128, flame_flicker_depth=13,
-                          flame_flicker_speed=13, pir_sensitivity=16):
+                          flame_flicker_speed=13, pir_sensitivity=16,
+                          auto_suppress_min=60, flame_style=0, effect_id=0):
         """Write a full scene to char AA04."""
         name_bytes = name.encode("utf-8")[:16]
         data = bytearray()
@@ -176,6 +180,9 @@ class LampBLE:
         data.extend([flame_drift_x, flame_drift_y, flame_restore, flame_radius,
                      flame_bias_y, flame_flicker_depth, flame_flicker_speed])
         data.append(pir_sensitivity)
+        data.extend(struct.pack("<H", auto_suppress_min))
+        data.append(flame_style)
+        data.append(effect_id)
         await self._client.write_gatt_char(CHAR_SCENE_WRITE, bytes(data))
         print(f"[BLE] write_scene(idx={index}, name='{name}', "
               f"[{warm},{neutral},{cool},{master}] flags=0x{flags:02x})")
@@ -199,6 +206,32 @@ class LampBLE:
         await self._client.write_gatt_char(CHAR_LAMP_NAME, name.encode("utf-8")[:32])
         print(f"[BLE] set_name('{name}')")
 
+    # ── Frame Diagnostics ──
+
+    DIAG_HISTS = ("pack", "lock_wait", "tx", "jitter")
+
+    async def get_frame_diag(self) -> dict:
+        """Read frame counters and timing histograms (bin i = samples < 16<<i us)."""
+        data = await self._client.read_gatt_char(CHAR_FRAME_DIAG)
+        version, bins = data[0], data[1]
+        frames, dropped, skipped, tx_errors, missed = struct.unpack_from("<5I", data, 2)
+        diag = {"version": version, "frames": frames, "dropped": dropped,
+                "skipped": skipped, "tx_errors": tx_errors, "missed_ticks": missed}
+        off = 22
+        for name in self.DIAG_HISTS:
+            vals = struct.unpack_from(f"<{bins + 1}I", data, off)
+            diag[name] = {"bins": list(vals[:bins]), "max_us": vals[bins]}
+            off += (bins + 1) * 4
+        return diag
+
+    async def frame_diag_log(self):
+        """Ask the lamp to dump frame timing to its serial log."""
+        await self._client.write_gatt_char(CHAR_FRAME_DIAG, bytes([0x01]))
+
+    async def frame_diag_reset(self):
+        await self._client.write_gatt_char(CHAR_FRAME_DIAG, bytes([0x02]))
+        print("[BLE] frame_diag_reset()")
+
 
 # ── Serial Monitor ──
 
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""
+LED Frame Trace Renderer
+
+Reads a binary frame trace written by the led_driver capture backend
+(Firmware/test_apps/led_capture, linux target) and renders it as an image.
+
+Usage:
+    python3 led_trace.py led_trace.bin -o strip.ppm             # one row per frame
+    python3 led_trace.py led_trace.bin -o grid.png --grid       # physical layout per frame
+    python3 led_trace.py led_trace.bin --info                   # frame count / timing summary
+
+PPM output needs no dependencies; PNG output requires Pillow.
+"""
+
+import argparse
+import struct
+import sys
+from dataclasses import dataclass
+
+TRACE_MAGIC = b"LEDT"
+
+# Approximate sRGB of each SK6812WWA die at full drive
+RGB_WARM    = (255, 147, 41)
+RGB_NEUTRAL = (255, 228, 206)
+RGB_COOL    = (201, 226, 255)
+
+
+@dataclass
+class Trace:
+    led_count: int
+    coords: list            # [(col, row)] per LED, index 0 = D1
+    frames: list            # [(timestamp_us, bytes)]
+
+
+def load_trace(path: str) -> Trace:
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != TRACE_MAGIC:
+        raise ValueError(f"{path}: not an LED trace (bad magic)")
+    version, led_count, bpl = struct.unpack_from("<HHB", data, 4)
+    if version != 1 or bpl != 3:
+        raise ValueError(f"{path}: unsupported trace version {version} / {bpl} B per LED")
+    off = 10
+    coords = [tuple(data[off + 2 * i: off + 2 * i + 2]) for i in range(led_count)]
+    off += 2 * led_count
+
+    frames = []
+    while off + 10 <= len(data):
+        ts, length = struct.unpack_from("<QH", data, off)
+        off += 10
+        if off + length > len(data):
+            break           # truncated last record (writer killed mid-frame)
+        frames.append((ts, data[off:off + length]))
+        off += length
+    return Trace(led_count, coords, frames)
+
+
+def led_rgb(frame: bytes, i: int) -> tuple:
+    """Mix one LED's [cool, warm, neutral] drive levels into an sRGB colour."""
+    cool, warm, neutral = frame[3 * i], frame[3 * i + 1], frame[3 * i + 2]
+    return tuple(min(255, (warm * w + neutral * n + cool * c) // 255)
+                 for w, n, c in zip(RGB_WARM, RGB_NEUTRAL, RGB_COOL))
+
+
+def render_strip(trace: Trace, scale: int) -> tuple:
+    """One row per frame, LEDs left to right in index order."""
+    width, height = trace.led_count * scale, len(trace.frames) * scale
+    px = bytearray(width * height * 3)
+    for y, (_, frame) in enumerate(trace.frames):
+        row = bytearray()
+        for i in range(trace.led_count):
+            row += bytes(led_rgb(frame, i)) * scale
+        for dy in range(scale):
+            start = ((y * scale + dy) * width) * 3
+            px[start:start + len(row)] = row
+    return width, height, px
+
+
+def render_grid(trace: Trace, scale: int, per_row: int) -> tuple:
+    """Each frame drawn on the physical LED grid, frames tiled in rows."""
+    cols = max(c for c, _ in trace.coords) + 1
+    rows = max(r for _, r in trace.coords) + 1
+    cell_w, cell_h = (cols + 1) * scale, (rows + 1) * scale     # 1-cell gutter
+    n = len(trace.frames)
+    tiles_x = min(per_row, n) or 1
+    tiles_y = (n + tiles_x - 1) // tiles_x
+    width, height = tiles_x * cell_w, tiles_y * cell_h
+    px = bytearray(width * height * 3)
+    for k, (_, frame) in enumerate(trace.frames):
+        ox, oy = (k % tiles_x) * cell_w, (k // tiles_x) * cell_h
+        for i, (c, r) in enumerate(trace.coords):
+            rgb = bytes(led_rgb(frame, i))
+            for dy in range(scale):
+                start = ((oy + r * scale + dy) * width + ox + c * scale) * 3
+                px[start:start + 3 * scale] = rgb * scale
+    return width, height, px
+
+
+def write_image(path: str, width: int, height: int, px: bytearray):
+    if path.lower().endswith(".png"):
+        try:
+            from PIL import Image
+        except ImportError:
+            sys.exit("PNG output requires Pillow (pip install pillow); use .ppm instead")
+        Image.frombytes("RGB", (width, height), bytes(px)).save(path)
+    else:
+        with open(path, "wb") as f:
+            f.write(f"P6\n{width} {height}\n255\n".encode("ascii"))
+            f.write(px)
+
+
+def print_info(trace: Trace):
+    n = len(trace.frames)
+    print(f"LEDs: {trace.led_count}  frames: {n}")
+    if n > 1:
+        ts = [t for t, _ in trace.frames]
+        gaps = [b - a for a, b in zip(ts, ts[1:])]
+        span = (ts[-1] - ts[0]) / 1e6
+        print(f"Span: {span:.3f} s  interval min/avg/max: "
+              f"{min(gaps)}/{sum(gaps) // len(gaps)}/{max(gaps)} us")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Render an LED frame trace")
+    parser.add_argument("trace", help="Trace file written by the capture backend")
+    parser.add_argument("-o", "--output", help="Output image (.ppm or .png)")
+    parser.add_argument("--grid", action="store_true",
+                        help="Draw each frame on the physical LED layout")
+    parser.add_argument("--scale", type=int, default=8, help="Pixels per LED (default 8)")
+    parser.add_argument("--per-row", type=int, default=16,
+                        help="Frames per row in --grid mode (default 16)")
+    parser.add_argument("--info", action="store_true", help="Print a trace summary")
+    args = parser.parse_args()
+
+    trace = load_trace(args.trace)
+    if args.info or not args.output:
+        print_info(trace)
+    if args.output:
+        if args.grid:
+            w, h, px = render_grid(trace, args.scale, args.per_row)
+        else:
+            w, h, px = render_strip(trace, args.scale)
+        write_image(args.output, w, h, px)
+        print(f"Wrote {args.output} ({w}x{h}, {len(trace.frames)} frames)")
+
+
+if __name__ == "__main__":
+    main()
@@ -677,7 +677,7 @@ async def test_flame_config_sync():
     await lamp.set_flame_config(
         drift_x=200, drift_y=50, restore=30,
         radius=180, bias_y=64, flicker_depth=25,
-        flicker_speed=20, brightness=200
+        flicker_speed=20, style=1
     )
     rx = monitor.wait_for_sync_rx(timeout=SYNC_TIMEOUT)
 
@@ -688,7 +688,7 @@ async def test_flame_config_sync():
         # Extended logging not yet on this firmware
         result.fail(name, "Flame config fields are all zeros (firmware log not extended?)")
     else:
-        expected = [200, 50, 30, 180, 64, 25, 20, 200]
+        expected = [200, 50, 30, 180, 64, 25, 20, 1]
         if rx.flame_config == expected:
             result.ok(name, f"flame={rx.flame_config}")
         else: